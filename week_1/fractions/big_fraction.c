@@ -0,0 +1,411 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "big_fraction.h"
+
+/* Natural numbers ************************************************************/
+
+/* A natural number in base 2^32, least significant limb first. Zero has no
+   limbs, and the most significant limb of any other number is not zero. */
+typedef struct {
+    int size;
+    uint32_t * limbs;
+} Natural;
+
+static Natural nat_alloc ( int size ) {
+    Natural n = { size, (uint32_t *) calloc(size > 0 ? size : 1, sizeof(uint32_t)) };
+    if ( n.limbs == NULL ) {
+        printf("Could not allocate memory for BigFraction\n");
+        exit(1);
+    }
+    return n;
+}
+
+static void nat_free ( Natural n ) {
+    free(n.limbs);
+}
+
+static void nat_trim ( Natural * n ) {
+    while ( n->size > 0 && n->limbs[n->size-1] == 0 ) {
+        n->size--;
+    }
+}
+
+static Natural nat_from_u64 ( uint64_t x ) {
+    Natural n = nat_alloc(2);
+    n.limbs[0] = (uint32_t) x;
+    n.limbs[1] = (uint32_t) (x >> 32);
+    nat_trim(&n);
+    return n;
+}
+
+static Natural nat_copy ( Natural a ) {
+    Natural n = nat_alloc(a.size);
+    memcpy(n.limbs, a.limbs, a.size * sizeof(uint32_t));
+    return n;
+}
+
+/* Sets *x to a and returns 1 if a fits in 64 bits */
+static int nat_to_u64 ( Natural a, uint64_t * x ) {
+    if ( a.size > 2 ) {
+        return 0;
+    }
+    *x = 0;
+    for ( int i=a.size-1; i>=0; i-- ) {
+        *x = (*x << 32) | a.limbs[i];
+    }
+    return 1;
+}
+
+static int nat_is_one ( Natural a ) {
+    return a.size == 1 && a.limbs[0] == 1;
+}
+
+static int nat_compare ( Natural a, Natural b ) {
+    if ( a.size != b.size ) {
+        return a.size < b.size ? -1 : 1;
+    }
+    for ( int i=a.size-1; i>=0; i-- ) {
+        if ( a.limbs[i] != b.limbs[i] ) {
+            return a.limbs[i] < b.limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static Natural nat_add ( Natural a, Natural b ) {
+    if ( a.size < b.size ) {
+        Natural temp = a;
+        a = b;
+        b = temp;
+    }
+    Natural n = nat_alloc(a.size + 1);
+    uint64_t carry = 0;
+    for ( int i=0; i<a.size; i++ ) {
+        carry += (uint64_t) a.limbs[i] + (i < b.size ? b.limbs[i] : 0);
+        n.limbs[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    n.limbs[a.size] = (uint32_t) carry;
+    nat_trim(&n);
+    return n;
+}
+
+/* a -= b, where a >= b */
+static void nat_subtract_from ( Natural * a, Natural b ) {
+    int64_t borrow = 0;
+    for ( int i=0; i<a->size; i++ ) {
+        borrow += (int64_t) a->limbs[i] - (i < b.size ? b.limbs[i] : 0);
+        a->limbs[i] = (uint32_t) borrow;
+        borrow >>= 32;
+    }
+    nat_trim(a);
+}
+
+static Natural nat_multiply ( Natural a, Natural b ) {
+    Natural n = nat_alloc(a.size + b.size);
+    for ( int i=0; i<a.size; i++ ) {
+        uint64_t carry = 0;
+        for ( int j=0; j<b.size; j++ ) {
+            carry += (uint64_t) a.limbs[i] * b.limbs[j] + n.limbs[i+j];
+            n.limbs[i+j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        n.limbs[i+b.size] = (uint32_t) carry;
+    }
+    nat_trim(&n);
+    return n;
+}
+
+static int nat_trailing_zeros ( Natural a ) {
+    int i = 0;
+    while ( a.limbs[i] == 0 ) {
+        i++;
+    }
+    return 32 * i + __builtin_ctz(a.limbs[i]);
+}
+
+static void nat_shift_right ( Natural * a, int bits ) {
+    int limbs = bits / 32;
+    bits %= 32;
+    for ( int i=0; i + limbs < a->size; i++ ) {
+        uint64_t x = a->limbs[i+limbs];
+        if ( i + limbs + 1 < a->size ) {
+            x |= (uint64_t) a->limbs[i+limbs+1] << 32;
+        }
+        a->limbs[i] = (uint32_t) (x >> bits);
+    }
+    a->size = limbs < a->size ? a->size - limbs : 0;
+    nat_trim(a);
+}
+
+static Natural nat_shift_left ( Natural a, int bits ) {
+    int limbs = bits / 32;
+    bits %= 32;
+    Natural n = nat_alloc(a.size + limbs + 1);
+    for ( int i=0; i<a.size; i++ ) {
+        uint64_t x = (uint64_t) a.limbs[i] << bits;
+        n.limbs[i+limbs] |= (uint32_t) x;
+        n.limbs[i+limbs+1] |= (uint32_t) (x >> 32);
+    }
+    nat_trim(&n);
+    return n;
+}
+
+/* a /= d, returning the remainder */
+static uint32_t nat_divide_small ( Natural * a, uint32_t d ) {
+    uint64_t r = 0;
+    for ( int i=a->size-1; i>=0; i-- ) {
+        r = (r << 32) | a->limbs[i];
+        a->limbs[i] = (uint32_t) (r / d);
+        r %= d;
+    }
+    nat_trim(a);
+    return (uint32_t) r;
+}
+
+/* a / b, by shift and subtract one bit at a time. It is only used to divide
+   out gcds, which keeps it off the common path. */
+static Natural nat_divide ( Natural a, Natural b ) {
+    if ( b.size == 1 ) {
+        Natural q = nat_copy(a);
+        nat_divide_small(&q, b.limbs[0]);
+        return q;
+    }
+    Natural q = nat_alloc(a.size),
+            r = nat_alloc(b.size + 1);
+    r.size = 0;
+    for ( int bit = 32 * a.size - 1; bit >= 0; bit-- ) {
+        /* r = 2r + next bit of a */
+        uint32_t carry = (a.limbs[bit/32] >> (bit%32)) & 1;
+        for ( int i=0; i<r.size; i++ ) {
+            uint32_t top = r.limbs[i] >> 31;
+            r.limbs[i] = (r.limbs[i] << 1) | carry;
+            carry = top;
+        }
+        if ( carry ) {
+            r.limbs[r.size++] = carry;
+        }
+        if ( nat_compare(r, b) >= 0 ) {
+            nat_subtract_from(&r, b);
+            q.limbs[bit/32] |= 1u << (bit%32);
+        }
+    }
+    nat_free(r);
+    nat_trim(&q);
+    return q;
+}
+
+/* Binary gcd of two non-zero numbers, using the 64 bit version once they
+   are small enough */
+static Natural nat_gcd ( Natural a, Natural b ) {
+    uint64_t x, y;
+    if ( nat_to_u64(a, &x) && nat_to_u64(b, &y) ) {
+        return nat_from_u64(gcd(x, y));
+    }
+    a = nat_copy(a);
+    b = nat_copy(b);
+    int za = nat_trailing_zeros(a), zb = nat_trailing_zeros(b),
+        shift = za < zb ? za : zb;
+    nat_shift_right(&a, za);
+    do {
+        nat_shift_right(&b, nat_trailing_zeros(b));
+        if ( nat_compare(a, b) > 0 ) {
+            Natural temp = a;
+            a = b;
+            b = temp;
+        }
+        nat_subtract_from(&b, a);
+        if ( nat_to_u64(a, &x) && nat_to_u64(b, &y) ) {
+            nat_free(b);
+            b = nat_from_u64(gcd(x, y));
+            nat_free(a);
+            a = nat_alloc(0);
+            break;
+        }
+    } while ( b.size > 0 );
+    /* the gcd is in whichever of a and b is not zero */
+    Natural g = nat_shift_left(b.size > 0 ? b : a, shift);
+    nat_free(a);
+    nat_free(b);
+    return g;
+}
+
+/* BigFraction ****************************************************************/
+
+struct BigFraction {
+    int sign;    /* -1, 0 or 1 */
+    Natural num; /* magnitude of the numerator */
+    Natural den; /* denominator, at least 1 */
+};
+
+/* Replaces the value of a with sign * num / den, reduced, taking ownership
+   of num and den */
+static void assign ( BigFraction * a, int sign, Natural num, Natural den ) {
+    nat_free(a->num);
+    nat_free(a->den);
+    if ( num.size == 0 ) {
+        nat_free(den);
+        a->sign = 0;
+        a->num = num;
+        a->den = nat_from_u64(1);
+        return;
+    }
+    Natural g = nat_gcd(num, den);
+    if ( !nat_is_one(g) ) {
+        Natural n = nat_divide(num, g), d = nat_divide(den, g);
+        nat_free(num);
+        nat_free(den);
+        num = n;
+        den = d;
+    }
+    nat_free(g);
+    a->sign = sign;
+    a->num = num;
+    a->den = den;
+}
+
+BigFraction * BigFraction_new ( Fraction a ) {
+    assert(a.den > 0);
+    BigFraction * f = (BigFraction *) malloc(sizeof(BigFraction));
+    if ( f == NULL ) {
+        printf("Could not allocate memory for BigFraction\n");
+        exit(1);
+    }
+    f->sign = (a.num > 0) - (a.num < 0);
+    f->num = nat_from_u64(a.num < 0 ? -(uint64_t) a.num : (uint64_t) a.num);
+    f->den = nat_from_u64(a.den);
+    return f;
+}
+
+BigFraction * BigFraction_copy ( const BigFraction * a ) {
+    BigFraction * f = BigFraction_new((Fraction) { 0, 1 });
+    nat_free(f->num);
+    nat_free(f->den);
+    f->sign = a->sign;
+    f->num = nat_copy(a->num);
+    f->den = nat_copy(a->den);
+    return f;
+}
+
+void BigFraction_destroy ( BigFraction * a ) {
+    nat_free(a->num);
+    nat_free(a->den);
+    free(a);
+}
+
+/* a = a + sign * b */
+static void add_signed ( BigFraction * a, const BigFraction * b, int sign ) {
+    sign *= b->sign;
+    Natural x = nat_multiply(a->num, b->den),
+            y = nat_multiply(b->num, a->den),
+            den = nat_multiply(a->den, b->den);
+    if ( a->sign == 0 || sign == 0 || a->sign == sign ) {
+        Natural num = nat_add(x, y);
+        nat_free(x);
+        nat_free(y);
+        assign(a, a->sign != 0 ? a->sign : sign, num, den);
+    } else if ( nat_compare(x, y) >= 0 ) {
+        nat_subtract_from(&x, y);
+        nat_free(y);
+        assign(a, a->sign, x, den);
+    } else {
+        nat_subtract_from(&y, x);
+        nat_free(x);
+        assign(a, sign, y, den);
+    }
+}
+
+void BigFraction_add ( BigFraction * a, const BigFraction * b ) {
+    add_signed(a, b, 1);
+}
+
+void BigFraction_subtract ( BigFraction * a, const BigFraction * b ) {
+    add_signed(a, b, -1);
+}
+
+void BigFraction_multiply ( BigFraction * a, const BigFraction * b ) {
+    assign(a, a->sign * b->sign, nat_multiply(a->num, b->num), nat_multiply(a->den, b->den));
+}
+
+void BigFraction_divide ( BigFraction * a, const BigFraction * b ) {
+    assert(b->sign != 0);
+    assign(a, a->sign * b->sign, nat_multiply(a->num, b->den), nat_multiply(a->den, b->num));
+}
+
+int BigFraction_compare ( const BigFraction * a, const BigFraction * b ) {
+    if ( a->sign != b->sign ) {
+        return a->sign < b->sign ? -1 : 1;
+    }
+    Natural x = nat_multiply(a->num, b->den),
+            y = nat_multiply(b->num, a->den);
+    int result = a->sign * nat_compare(x, y);
+    nat_free(x);
+    nat_free(y);
+    return result;
+}
+
+int BigFraction_to_fraction ( const BigFraction * a, Fraction * result ) {
+    uint64_t num, den;
+    if ( !nat_to_u64(a->num, &num) || !nat_to_u64(a->den, &den) ||
+         num > INT64_MAX || den > INT64_MAX ) {
+        return 0;
+    }
+    *result = (Fraction) { a->sign * (int64_t) num, (int64_t) den };
+    return 1;
+}
+
+/* Appends the decimal digits of n to s, which has room for them */
+static char * append_decimal ( char * s, Natural n ) {
+    /* base 10^9 digits, least significant first */
+    uint32_t * chunks = (uint32_t *) malloc((n.size * 32 / 29 + 2) * sizeof(uint32_t));
+    int count = 0;
+    n = nat_copy(n);
+    do {
+        chunks[count++] = nat_divide_small(&n, 1000000000);
+    } while ( n.size > 0 );
+    s += sprintf(s, "%u", chunks[count-1]);
+    for ( int i=count-2; i>=0; i-- ) {
+        s += sprintf(s, "%09u", chunks[i]);
+    }
+    free(chunks);
+    nat_free(n);
+    return s;
+}
+
+char * BigFraction_to_string ( const BigFraction * a ) {
+    /* each limb needs at most 10 decimal digits */
+    char * s = (char *) malloc(10 * (a->num.size + a->den.size) + 24);
+    if ( s == NULL ) {
+        printf("Could not allocate memory for BigFraction\n");
+        exit(1);
+    }
+    char * p = s;
+    if ( a->sign < 0 ) {
+        *p++ = '-';
+    }
+    p = append_decimal(p, a->num);
+    *p++ = '/';
+    append_decimal(p, a->den);
+    return s;
+}
+
+/* Sums runs of fractions in a Fraction, and adds each run's total into the
+   BigFraction only when the next term would overflow it */
+BigFraction * BigFraction_sum ( const Fraction * x, int n ) {
+    BigFraction * total = BigFraction_new((Fraction) { 0, 1 });
+    Fraction partial = { 0, 1 };
+    for ( int i=0; i<n; i++ ) {
+        if ( !add_checked(partial, x[i], &partial) ) {
+            BigFraction * p = BigFraction_new(partial);
+            BigFraction_add(total, p);
+            BigFraction_destroy(p);
+            partial = x[i];
+        }
+    }
+    BigFraction * p = BigFraction_new(partial);
+    BigFraction_add(total, p);
+    BigFraction_destroy(p);
+    return total;
+}
@@ -0,0 +1,70 @@
+#ifndef BIG_FRACTION_H
+#define BIG_FRACTION_H
+
+#include "fraction.h"
+
+/*! @file */
+
+/*! \brief Arbitrary precision fractions
+ *
+ *  A BigFraction is exact however large its numerator and denominator grow,
+ *  at the cost of heap allocation and much slower arithmetic than Fraction.
+ *  It is the fallback for when a Fraction operation overflows: convert the
+ *  operands with BigFraction_new, carry on, and convert back with
+ *  BigFraction_to_fraction when the result is small again. Like Fraction
+ *  results, BigFractions are always in lowest terms.
+ */
+typedef struct BigFraction BigFraction;
+
+/*! Make a new BigFraction with the value of a fraction
+ *  \param a A fraction in lowest terms
+ */
+BigFraction * BigFraction_new ( Fraction a );
+
+/*! Make a new BigFraction with the same value as another
+ *  \param a The BigFraction to copy
+ */
+BigFraction * BigFraction_copy ( const BigFraction * a );
+
+/*! Free a BigFraction and everything it holds
+ *  \param a The BigFraction
+ */
+void BigFraction_destroy ( BigFraction * a );
+
+/*! Arithmetic, in place: a = a + b, a - b, a * b or a / b
+ *  \param a The first operand, which receives the result
+ *  \param b The second operand, which may be a. For divide it must not be zero.
+ */
+void BigFraction_add ( BigFraction * a, const BigFraction * b );
+void BigFraction_subtract ( BigFraction * a, const BigFraction * b );
+void BigFraction_multiply ( BigFraction * a, const BigFraction * b );
+void BigFraction_divide ( BigFraction * a, const BigFraction * b );
+
+/*! Compare two BigFractions
+ *  \return A negative number, zero or a positive number as a is less than,
+ *          equal to or greater than b
+ */
+int BigFraction_compare ( const BigFraction * a, const BigFraction * b );
+
+/*! Convert back to a Fraction
+ *  \param a The BigFraction
+ *  \param result Receives the value of a, if it fits
+ *  \return 1 if a fits in a Fraction, 0 otherwise
+ */
+int BigFraction_to_fraction ( const BigFraction * a, Fraction * result );
+
+/*! A string representation of a BigFraction, like "-22/15"
+ *  \param a The BigFraction
+ *  \return A new string, which the caller should free
+ */
+char * BigFraction_to_string ( const BigFraction * a );
+
+/*! The exact sum of an array of fractions. It is accumulated in a Fraction
+ *  while that does not overflow, and in a BigFraction from then on.
+ *  \param x Fractions in lowest terms
+ *  \param n The number of fractions
+ *  \return A new BigFraction, which the caller should destroy
+ */
+BigFraction * BigFraction_sum ( const Fraction * x, int n );
+
+#endif
@@ -1,9 +1,154 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "fraction.h"
 
+typedef __int128 int128;
+typedef unsigned __int128 uint128;
+
+/* Fractions never hold INT64_MIN, so that every value can be negated */
+static int fits ( int128 x ) {
+    return x >= -INT64_MAX && x <= INT64_MAX;
+}
+
+static int store ( int128 num, int128 den, Fraction * result ) {
+    if ( !fits(num) || !fits(den) ) {
+        return 0;
+    }
+    *result = (Fraction) { (int64_t) num, (int64_t) den };
+    return 1;
+}
+
+static uint128 magnitude ( int128 x ) {
+    return x < 0 ? -(uint128) x : (uint128) x;
+}
+
+static Fraction or_exit ( int ok, Fraction result, const char * operation ) {
+    if ( !ok ) {
+        printf("Fraction overflow in %s\n", operation);
+        exit(1);
+    }
+    return result;
+}
+
+uint64_t gcd ( uint64_t a, uint64_t b ) {
+    if ( a == 0 ) return b;
+    if ( b == 0 ) return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if ( a > b ) {
+            uint64_t temp = a;
+            a = b;
+            b = temp;
+        }
+        b -= a;
+    } while ( b != 0 );
+    return a << shift;
+}
+
+Fraction reduce ( Fraction a ) {
+    assert(a.den != 0);
+    int128 num = a.num, den = a.den;
+    if ( den < 0 ) {
+        num = -num;
+        den = -den;
+    }
+    uint64_t g = gcd((uint64_t) magnitude(num), (uint64_t) den);
+    Fraction result;
+    return or_exit(store(num / g, den / g, &result), result, "reduce");
+}
+
+/* a + b for fractions in lowest terms, dividing out common factors as it goes
+   (Knuth, TAOCP 4.5.1) so that only the final gcd is of a 128 bit number, and
+   only when the denominators share a factor */
+int add_checked ( Fraction a, Fraction b, Fraction * result ) {
+    uint64_t d1 = gcd(a.den, b.den);
+    if ( d1 == 1 ) {
+        return store((int128) a.num * b.den + (int128) b.num * a.den,
+                     (int128) a.den * b.den, result);
+    }
+    int64_t ad = a.den / d1, bd = b.den / d1;
+    int128 t = (int128) a.num * bd + (int128) b.num * ad;
+    if ( t == 0 ) {
+        *result = (Fraction) { 0, 1 };
+        return 1;
+    }
+    uint64_t d2 = gcd((uint64_t) (magnitude(t) % d1), d1);
+    return store(t / d2, (int128) ad * (b.den / d2), result);
+}
+
+int subtract_checked ( Fraction a, Fraction b, Fraction * result ) {
+    b.num = -b.num;
+    return add_checked(a, b, result);
+}
+
+/* Cancels across the two fractions before multiplying, so the product is
+   already in lowest terms */
+int multiply_checked ( Fraction a, Fraction b, Fraction * result ) {
+    if ( a.num == 0 || b.num == 0 ) {
+        *result = (Fraction) { 0, 1 };
+        return 1;
+    }
+    int64_t g1 = gcd(magnitude(a.num), b.den),
+            g2 = gcd(magnitude(b.num), a.den);
+    return store((int128) (a.num / g1) * (b.num / g2),
+                 (int128) (a.den / g2) * (b.den / g1), result);
+}
+
+int divide_checked ( Fraction a, Fraction b, Fraction * result ) {
+    assert(b.num != 0);
+    Fraction reciprocal = b.num < 0 ? (Fraction) { -b.den, -b.num }
+                                    : (Fraction) { b.den, b.num };
+    return multiply_checked(a, reciprocal, result);
+}
+
 Fraction add ( Fraction a, Fraction b ) {
-  return (Fraction) { a.num * b.den + a.den * b.num, a.den * b.den };
+    Fraction result;
+    int ok = add_checked(a, b, &result);
+    return or_exit(ok, result, "add");
+}
+
+Fraction subtract ( Fraction a, Fraction b ) {
+    Fraction result;
+    int ok = subtract_checked(a, b, &result);
+    return or_exit(ok, result, "subtract");
 }
 
 Fraction multiply ( Fraction a, Fraction b ) {
-  return (Fraction) { a.num * b.num, a.den * b.den };
-}
\ No newline at end of file
+    Fraction result;
+    int ok = multiply_checked(a, b, &result);
+    return or_exit(ok, result, "multiply");
+}
+
+Fraction divide ( Fraction a, Fraction b ) {
+    Fraction result;
+    int ok = divide_checked(a, b, &result);
+    return or_exit(ok, result, "divide");
+}
+
+/* Cross multiplication in 128 bits is exact, so no reduction is needed */
+int compare ( Fraction a, Fraction b ) {
+    int128 x = (int128) a.num * b.den,
+           y = (int128) b.num * a.den;
+    return (x > y) - (x < y);
+}
+
+int add_arrays ( const Fraction * a, const Fraction * b, Fraction * result, int n ) {
+    for ( int i=0; i<n; i++ ) {
+        if ( !add_checked(a[i], b[i], result + i) ) {
+            return i;
+        }
+    }
+    return n;
+}
+
+int multiply_arrays ( const Fraction * a, const Fraction * b, Fraction * result, int n ) {
+    for ( int i=0; i<n; i++ ) {
+        if ( !multiply_checked(a[i], b[i], result + i) ) {
+            return i;
+        }
+    }
+    return n;
+}
@@ -1,6 +1,8 @@
 #ifndef FRACTION_H
 #define FRACTION_H
 
+#include <stdint.h>
+
 /*! @file */
 
 /*! \breif Fraction object and method definitions
@@ -8,22 +10,79 @@
  *  A fraction object is a struct with a numerator, denoted num, and
  *  a denominator, denoted den. Varions Methods that take fractions and return 
  *  fractions do arithmetical operations on them.
+ *
+ *  Results are always in lowest terms with a positive denominator. They are
+ *  computed with 128 bit intermediates, so no operation overflows unless its
+ *  reduced result does not fit in 64 bits. The plain operations exit with an
+ *  error message in that case; the _checked versions return 0 instead, and
+ *  BigFraction (big_fraction.h) can carry on exactly.
  */
 typedef struct {
-    int num;
-    int den;
+    int64_t num;
+    int64_t den;
 } Fraction;
 
+/*! The same fraction in lowest terms, with a positive denominator. The
+ *  operations below expect their arguments in this form, which every
+ *  fraction they return is in.
+ *  \param a A fraction whose denominator is not zero
+ */
+Fraction reduce ( Fraction a );
+
 /*! Add two fractions together
  *  \param a The first summand
  *  \param b The second summand
  */
 Fraction add ( Fraction a, Fraction b );
 
-/*! Multiply two fractions together (does not reduce)
+/*! Subtract one fraction from another
+ *  \param a The minuend
+ *  \param b The subtrahend
+ */
+Fraction subtract ( Fraction a, Fraction b );
+
+/*! Multiply two fractions together
  *  \param a The first term
  *  \param b The second term
  */
 Fraction multiply ( Fraction a, Fraction b );
 
-#endif
\ No newline at end of file
+/*! Divide one fraction by another
+ *  \param a The dividend
+ *  \param b The divisor, which must not be zero
+ */
+Fraction divide ( Fraction a, Fraction b );
+
+/*! Compare two fractions exactly
+ *  \param a The first fraction
+ *  \param b The second fraction
+ *  \return A negative number, zero or a positive number as a is less than,
+ *          equal to or greater than b
+ */
+int compare ( Fraction a, Fraction b );
+
+/*! Versions of the operations above that report overflow instead of
+ *  exiting. Each stores the result in *result and returns 1 if it fits in a
+ *  Fraction, and returns 0 leaving *result unchanged otherwise.
+ */
+int add_checked ( Fraction a, Fraction b, Fraction * result );
+int subtract_checked ( Fraction a, Fraction b, Fraction * result );
+int multiply_checked ( Fraction a, Fraction b, Fraction * result );
+int divide_checked ( Fraction a, Fraction b, Fraction * result );
+
+/*! Greatest common divisor, computed with the binary algorithm
+ *  \param a A non-negative number
+ *  \param b A non-negative number
+ *  \return gcd(a,b), which is a if b is zero and b if a is zero
+ */
+uint64_t gcd ( uint64_t a, uint64_t b );
+
+/*! Batch kernels: result[i] = a[i] + b[i], or a[i] * b[i], for i < n. The
+ *  arguments must be in lowest terms, as every result of this library is.
+ *  \return n, or the index of the first result that overflows, in which case
+ *          only the results before it have been written
+ */
+int add_arrays ( const Fraction * a, const Fraction * b, Fraction * result, int n );
+int multiply_arrays ( const Fraction * a, const Fraction * b, Fraction * result, int n );
+
+#endif
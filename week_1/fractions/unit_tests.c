@@ -1,4 +1,6 @@
+#include <stdlib.h>
 #include "fraction.h"
+#include "big_fraction.h"
 #include "gtest/gtest.h"
 
 namespace {
@@ -12,4 +14,136 @@ namespace {
         EXPECT_EQ(multiply(a,b).den,15);
     }
 
+    TEST(Fractions, Reduced) {
+        Fraction a = (Fraction) { 1, 6 },
+                 b = (Fraction) { 1, 3 },
+                 c = add(a, b);
+        EXPECT_EQ(c.num, 1);
+        EXPECT_EQ(c.den, 2);
+        c = subtract(a, a);
+        EXPECT_EQ(c.num, 0);
+        EXPECT_EQ(c.den, 1);
+        c = divide(b, (Fraction) { -2, 9 });
+        EXPECT_EQ(c.num, -3);
+        EXPECT_EQ(c.den, 2);
+        c = reduce((Fraction) { 12, -18 });
+        EXPECT_EQ(c.num, -2);
+        EXPECT_EQ(c.den, 3);
+        EXPECT_EQ(gcd(48, 180), 12);
+        EXPECT_EQ(gcd(0, 7), 7);
+        EXPECT_LT(compare(a, b), 0);
+        EXPECT_GT(compare(b, a), 0);
+        EXPECT_EQ(compare(c, (Fraction) { -2, 3 }), 0);
+
+        /* Summing 1/k(k+1) telescopes to n/(n+1); unreduced, the denominator
+           would overflow after a few terms */
+        Fraction s = { 0, 1 };
+        for ( int k=1; k<=1000; k++ ) {
+            s = add(s, (Fraction) { 1, (int64_t) k * (k + 1) });
+        }
+        EXPECT_EQ(s.num, 1000);
+        EXPECT_EQ(s.den, 1001);
+    }
+
+    TEST(Fractions, Overflow) {
+        Fraction big = { INT64_MAX, 1 },
+                 tiny = { 1, INT64_MAX - 1 },
+                 r = { 5, 7 };
+        EXPECT_EQ(add_checked(big, big, &r), 0);
+        EXPECT_EQ(r.num, 5); // unchanged
+        EXPECT_EQ(multiply_checked(tiny, tiny, &r), 0);
+        EXPECT_EQ(multiply_checked(big, tiny, &r), 1); // intermediates exceed 64 bits
+        EXPECT_EQ(r.num, INT64_MAX);
+        EXPECT_EQ(r.den, INT64_MAX - 1);
+        EXPECT_EQ(subtract_checked(big, big, &r), 1);
+        EXPECT_EQ(r.num, 0);
+        EXPECT_EQ(compare(tiny, (Fraction) { 1, INT64_MAX }), 1);
+    }
+
+    TEST(Fractions, Batch) {
+        Fraction a[100], b[100], c[100];
+        for ( int i=0; i<100; i++ ) {
+            a[i] = (Fraction) { i, 100 + i };
+            b[i] = (Fraction) { 1, 2 };
+            a[i] = reduce(a[i]);
+        }
+        ASSERT_EQ(add_arrays(a, b, c, 100), 100);
+        for ( int i=0; i<100; i++ ) {
+            EXPECT_EQ(compare(c[i], add(a[i], b[i])), 0);
+        }
+        ASSERT_EQ(multiply_arrays(a, b, c, 100), 100);
+        EXPECT_EQ(c[50].num, 1);
+        EXPECT_EQ(c[50].den, 6);
+        b[10] = (Fraction) { INT64_MAX, 1 };
+        EXPECT_EQ(multiply_arrays(b, b, c, 100), 10);
+    }
+
+    TEST(BigFractions, Arithmetic) {
+        BigFraction * x = BigFraction_new((Fraction) { INT64_MAX, 3 }),
+                    * y = BigFraction_copy(x);
+        char * s;
+
+        BigFraction_multiply(x, y);
+        BigFraction_multiply(x, y);
+        s = BigFraction_to_string(x);
+        EXPECT_STREQ(s, "784637716923335095224261902710254454442933591094742482943/27");
+        free(s);
+
+        Fraction f;
+        EXPECT_EQ(BigFraction_to_fraction(x, &f), 0);
+        BigFraction_divide(x, y);
+        BigFraction_divide(x, y);
+        EXPECT_EQ(BigFraction_compare(x, y), 0);
+        EXPECT_EQ(BigFraction_to_fraction(x, &f), 1);
+        EXPECT_EQ(f.num, INT64_MAX);
+        EXPECT_EQ(f.den, 3);
+
+        BigFraction_subtract(x, y);
+        BigFraction_subtract(x, y);
+        s = BigFraction_to_string(x);
+        EXPECT_STREQ(s, "-9223372036854775807/3");
+        free(s);
+        EXPECT_LT(BigFraction_compare(x, y), 0);
+        BigFraction_add(x, x);
+        BigFraction_add(x, y);
+        BigFraction_add(x, y);
+        s = BigFraction_to_string(x);
+        EXPECT_STREQ(s, "0/1");
+        free(s);
+
+        BigFraction_destroy(x);
+        BigFraction_destroy(y);
+    }
+
+    TEST(BigFractions, Sum) {
+        /* 1/p for the first primes: the exact sum has a denominator far
+           beyond 64 bits */
+        Fraction x[30];
+        int n = 0;
+        for ( int p=2; n<30; p++ ) {
+            int prime = 1;
+            for ( int d=2; d*d<=p; d++ ) {
+                if ( p % d == 0 ) prime = 0;
+            }
+            if ( prime ) x[n++] = (Fraction) { 1, p };
+        }
+        BigFraction * total = BigFraction_sum(x, 30),
+                    * check = BigFraction_new(x[0]);
+        for ( int i=1; i<30; i++ ) {
+            BigFraction * t = BigFraction_new(x[i]);
+            BigFraction_add(check, t);
+            BigFraction_destroy(t);
+        }
+        EXPECT_EQ(BigFraction_compare(total, check), 0);
+        Fraction f;
+        EXPECT_EQ(BigFraction_to_fraction(total, &f), 0);
+        BigFraction * small = BigFraction_sum(x, 5);
+        EXPECT_EQ(BigFraction_to_fraction(small, &f), 1);
+        EXPECT_EQ(f.num, 2927);
+        EXPECT_EQ(f.den, 2310);
+        BigFraction_destroy(total);
+        BigFraction_destroy(check);
+        BigFraction_destroy(small);
+    }
+
 }
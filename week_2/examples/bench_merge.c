@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "examples.h"
+
+/* Merges 64 sorted shards of 250k ids each (16M ints) by concatenating and
+   sorting with qsort, with merge_into, and with merge_into_parallel, and
+   compares join_into with a scalar copy loop. Build and run with make bench. */
+
+#define K 64
+#define LENGTH 250000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static int compare_ints ( const void * a, const void * b ) {
+    int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+int main ( void ) {
+
+    int * shards[K], lengths[K];
+    unsigned int seed = 1;
+    for ( int i=0; i<K; i++ ) {
+        lengths[i] = LENGTH;
+        shards[i] = (int *) malloc(LENGTH * sizeof(int));
+        int id = 0;
+        for ( int j=0; j<LENGTH; j++ ) {
+            seed = seed * 1103515245 + 12345;
+            id += 1 + (seed >> 16) % 128;
+            shards[i][j] = id;
+        }
+    }
+    const int * const * arrays = (const int * const *) shards;
+    int n = join_length(lengths, K);
+    int * result = (int *) malloc(n * sizeof(int)),
+        * check = (int *) malloc(n * sizeof(int));
+    memset(result, 0, n * sizeof(int)); /* so that page faults are not timed */
+    memset(check, 0, n * sizeof(int));
+
+    double t0 = seconds();
+    int m = 0;
+    for ( int i=0; i<K; i++ ) {
+        for ( int j=0; j<lengths[i]; j++ ) {
+            check[m++] = shards[i][j];
+        }
+    }
+    double t1 = seconds();
+    join_into(arrays, lengths, K, result);
+    double t2 = seconds();
+    printf("join %d ints: copy loop %.3f s, join_into %.3f s\n", n, t1 - t0, t2 - t1);
+
+    t0 = seconds();
+    qsort(check, n, sizeof(int), compare_ints);
+    t1 = seconds();
+    merge_into(arrays, lengths, K, result);
+    t2 = seconds();
+    printf("merge %d shards: qsort %.3f s, loser tree %.3f s%s\n", K, t1 - t0, t2 - t1,
+           memcmp(result, check, n * sizeof(int)) == 0 ? "" : " (WRONG)");
+
+    for ( int threads=2; threads<=8; threads*=2 ) {
+        t0 = seconds();
+        merge_into_parallel(arrays, lengths, K, result, threads);
+        t1 = seconds();
+        printf("  parallel merge, %d threads: %.3f s%s\n", threads, t1 - t0,
+               memcmp(result, check, n * sizeof(int)) == 0 ? "" : " (WRONG)");
+        memset(result, 0, n * sizeof(int));
+    }
+
+    for ( int i=0; i<K; i++ ) {
+        free(shards[i]);
+    }
+    free(result);
+    free(check);
+    return 0;
+
+}
@@ -1,12 +1,236 @@
+#include <limits.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <string.h>
 #include "examples.h"
 
 int * join(const int * a, int length_a, const int * b, int length_b) {
-    int * c = (int *) calloc(length_a+length_b, sizeof(int));
-    for (int i=0; i<length_a; i++ ) {
-        c[i] = a[i];
+    const int * arrays[] = { a, b };
+    int lengths[] = { length_a, length_b };
+    return join_all(arrays, lengths, 2);
+}
+
+int join_length(const int * lengths, int k) {
+    int n = 0;
+    for ( int i=0; i<k; i++ ) {
+        n += lengths[i];
+    }
+    return n;
+}
+
+int join_into(const int * const * arrays, const int * lengths, int k, int * result) {
+    int n = 0;
+    for ( int i=0; i<k; i++ ) {
+        if ( lengths[i] > 0 ) {
+            memcpy(result + n, arrays[i], lengths[i] * sizeof(int));
+            n += lengths[i];
+        }
+    }
+    return n;
+}
+
+int * join_all(const int * const * arrays, const int * lengths, int k) {
+    int n = join_length(lengths, k);
+    int * result = (int *) malloc((n > 0 ? n : 1) * sizeof(int));
+    join_into(arrays, lengths, k, result);
+    return result;
+}
+
+/* Loser tree ****************************************************************/
+
+/* Run i is at leaf k+i of a binary tree stored heap style, with node n's
+   children at 2n and 2n+1. Each internal node holds the loser of the match
+   played there, so replacing the winner's head only replays the matches on
+   its path to the root.
+
+   Players are 64 bit keys: the head value, offset to be unsigned, in the top
+   half and the run number in the bottom half. One unsigned comparison then
+   orders by value and breaks ties by run, which makes the merge stable, and
+   an exhausted run is EXHAUSTED, which loses to everything. */
+
+#define EXHAUSTED UINT64_MAX
+
+static uint64_t key ( const int * head, const int * end, int run ) {
+    if ( head == end ) {
+        return EXHAUSTED;
+    }
+    return ((uint64_t) ((uint32_t) *head ^ 0x80000000u) << 32) | (uint32_t) run;
+}
+
+static int key_value ( uint64_t key ) {
+    return (int) ((uint32_t) (key >> 32) ^ 0x80000000u);
+}
+
+/* Given the runs' keys in tree[0..k), plays all the matches, leaving the
+   losers in tree[1..k), and returns the overall winner */
+static uint64_t build ( uint64_t * tree, int k ) {
+    uint64_t * winners = (uint64_t *) malloc(2 * k * sizeof(uint64_t));
+    memcpy(winners + k, tree, k * sizeof(uint64_t));
+    for ( int n=k-1; n>=1; n-- ) {
+        uint64_t l = winners[2*n], r = winners[2*n+1];
+        winners[n] = l < r ? l : r;
+        tree[n] = l < r ? r : l;
     }
-    for (int i=0; i<length_b; i++ ) {
-        c[i+length_a] = b[i];
+    uint64_t winner = winners[1];
+    free(winners);
+    return winner;
+}
+
+/* Merges the runs [starts[i], ends[i]) into result */
+static void merge_runs ( const int ** starts, const int ** ends, int k, int * result ) {
+
+    int live = 0, last = 0;
+    for ( int i=0; i<k; i++ ) {
+        if ( starts[i] != ends[i] ) {
+            live++;
+            last = i;
+        }
+    }
+    if ( live <= 1 ) {
+        if ( live == 1 ) {
+            memcpy(result, starts[last], (ends[last] - starts[last]) * sizeof(int));
+        }
+        return;
+    }
+
+    const int ** heads = (const int **) malloc(k * sizeof(int *));
+    uint64_t * tree = (uint64_t *) malloc(k * sizeof(uint64_t));
+    for ( int i=0; i<k; i++ ) {
+        heads[i] = starts[i];
+        tree[i] = key(starts[i], ends[i], i);
+    }
+    uint64_t winner = build(tree, k);
+
+    while ( live > 1 ) {
+        int run = (uint32_t) winner;
+        *result++ = key_value(winner);
+        winner = key(++heads[run], ends[run], run);
+        if ( winner == EXHAUSTED ) {
+            live--;
+        }
+        /* written as min and max, which compile to conditional moves:
+           the outcome of each match is unpredictable */
+        for ( int n = (k + run) / 2; n >= 1; n /= 2 ) {
+            uint64_t other = tree[n];
+            tree[n] = other < winner ? winner : other;
+            winner = other < winner ? other : winner;
+        }
+    }
+
+    /* One run is left, and it is the winner */
+    int run = (uint32_t) winner;
+    memcpy(result, heads[run], (ends[run] - heads[run]) * sizeof(int));
+
+    free(tree);
+    free(heads);
+
+}
+
+int merge_into(const int * const * arrays, const int * lengths, int k, int * result) {
+    const int ** starts = (const int **) malloc((k > 0 ? k : 1) * sizeof(int *)),
+              ** ends = (const int **) malloc((k > 0 ? k : 1) * sizeof(int *));
+    for ( int i=0; i<k; i++ ) {
+        starts[i] = arrays[i];
+        ends[i] = arrays[i] + lengths[i];
     }
-    return c;
-}
\ No newline at end of file
+    merge_runs(starts, ends, k, result);
+    free(starts);
+    free(ends);
+    return join_length(lengths, k);
+}
+
+/* Parallel merge *************************************************************/
+
+static int lower_bound ( const int * x, int n, long long v ) {
+    int lo = 0, hi = n;
+    while ( lo < hi ) {
+        int mid = lo + (hi - lo) / 2;
+        if ( x[mid] < v ) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/* Finds where each array is cut so that the first rank elements of the
+   merged output come from before the cuts, splitting runs of equal values in
+   array order as merge_into does. The value at that rank is found by binary
+   search over the range of ints. */
+static void split ( const int * const * arrays, const int * lengths, int k, int rank, int * cuts ) {
+
+    if ( rank >= join_length(lengths, k) ) {
+        memcpy(cuts, lengths, k * sizeof(int));
+        return;
+    }
+
+    /* the smallest v with more than rank elements <= v */
+    long long lo = INT_MIN, hi = INT_MAX;
+    while ( lo < hi ) {
+        long long mid = lo + (hi - lo) / 2;
+        long long count = 0;
+        for ( int i=0; i<k; i++ ) {
+            count += lower_bound(arrays[i], lengths[i], mid + 1);
+        }
+        if ( count > rank ) hi = mid; else lo = mid + 1;
+    }
+
+    int remaining = rank;
+    for ( int i=0; i<k; i++ ) {
+        cuts[i] = lower_bound(arrays[i], lengths[i], lo);
+        remaining -= cuts[i];
+    }
+    for ( int i=0; i<k && remaining > 0; i++ ) {
+        int equal = lower_bound(arrays[i], lengths[i], lo + 1) - cuts[i],
+            take = equal < remaining ? equal : remaining;
+        cuts[i] += take;
+        remaining -= take;
+    }
+
+}
+
+typedef struct {
+    const int ** starts;
+    const int ** ends;
+    int k;
+    int * result;
+} MergeTask;
+
+static void * merge_task ( void * arg ) {
+    MergeTask * task = (MergeTask *) arg;
+    merge_runs(task->starts, task->ends, task->k, task->result);
+    return NULL;
+}
+
+int merge_into_parallel(const int * const * arrays, const int * lengths, int k, int * result, int threads) {
+
+    int n = join_length(lengths, k);
+    if ( threads <= 1 || k <= 1 || n < threads ) {
+        return merge_into(arrays, lengths, k, result);
+    }
+
+    /* cuts[t*k + i] is where thread t starts in array i */
+    int * cuts = (int *) malloc((threads + 1) * k * sizeof(int));
+    const int ** bounds = (const int **) malloc((threads + 1) * k * sizeof(int *));
+    for ( int t=0; t<=threads; t++ ) {
+        split(arrays, lengths, k, (long long) n * t / threads, cuts + t * k);
+        for ( int i=0; i<k; i++ ) {
+            bounds[t*k+i] = arrays[i] + cuts[t*k+i];
+        }
+    }
+
+    MergeTask * tasks = (MergeTask *) malloc(threads * sizeof(MergeTask));
+    pthread_t * ids = (pthread_t *) malloc(threads * sizeof(pthread_t));
+    for ( int t=0; t<threads; t++ ) {
+        tasks[t] = (MergeTask) { bounds + t * k, bounds + (t + 1) * k, k,
+                                 result + (long long) n * t / threads };
+        pthread_create(ids + t, NULL, merge_task, tasks + t);
+    }
+    for ( int t=0; t<threads; t++ ) {
+        pthread_join(ids[t], NULL);
+    }
+
+    free(ids);
+    free(tasks);
+    free(bounds);
+    free(cuts);
+    return n;
+
+}
@@ -5,4 +5,26 @@
 
 int * join(const int * a, int length_a, const int * b, int length_b);
 
-#endif
\ No newline at end of file
+/* k-way versions. Each takes k arrays, arrays[i] having lengths[i] ints. The
+   _into functions write into result, which must have room for
+   join_length(lengths, k) ints, so one buffer can be reused from call to call,
+   and return the number of ints written. */
+
+int join_length(const int * lengths, int k);
+
+/* The arrays end to end */
+int join_into(const int * const * arrays, const int * lengths, int k, int * result);
+
+/* The same, in a new buffer that the caller must free */
+int * join_all(const int * const * arrays, const int * lengths, int k);
+
+/* Merges k sorted arrays into one sorted array, using a loser tree: about
+   log2(k) comparisons per element. The merge is stable: equal values come
+   out in the order of the arrays they came from. */
+int merge_into(const int * const * arrays, const int * lengths, int k, int * result);
+
+/* The same result, computed by threads threads, each merging a slice of the
+   output found by binary search. Worth it for millions of elements. */
+int merge_into_parallel(const int * const * arrays, const int * lengths, int k, int * result, int threads);
+
+#endif
@@ -14,4 +14,60 @@ namespace {
         
     }
 
+    TEST(Examples,JoinAll) {
+        int x[] = { 0, 1 }, y[] = { 2 }, z[] = { 3, 4, 5 };
+        const int * arrays[] = { x, NULL, y, z };
+        int lengths[] = { 2, 0, 1, 3 };
+        ASSERT_EQ(join_length(lengths, 4), 6);
+        int * w = join_all(arrays, lengths, 4);
+        for (int i=0; i<6; i++ ) {
+            ASSERT_EQ(w[i], i);
+        }
+        free(w);
+    }
+
+    TEST(Examples,Merge) {
+        int x[] = { 1, 4, 4, 9 }, y[] = { 0, 4, 10 }, z[] = { -3, 4, 5, 6, 7 };
+        const int * arrays[] = { x, y, z };
+        int lengths[] = { 4, 3, 5 };
+        int expected[] = { -3, 0, 1, 4, 4, 4, 4, 5, 6, 7, 9, 10 };
+        int result[12];
+        ASSERT_EQ(merge_into(arrays, lengths, 3, result), 12);
+        for ( int i=0; i<12; i++ ) {
+            ASSERT_EQ(result[i], expected[i]);
+        }
+        ASSERT_EQ(merge_into(arrays, lengths, 1, result), 4);
+        ASSERT_EQ(result[3], 9);
+    }
+
+    TEST(Examples,MergeParallel) {
+        /* Shards of ids with many duplicates, so that the thread boundaries
+           fall inside runs of equal values */
+        const int k = 7;
+        int lengths[k], * shards[k];
+        for ( int i=0; i<k; i++ ) {
+            lengths[i] = 1000 + 337 * i;
+            shards[i] = (int *) malloc(lengths[i] * sizeof(int));
+            for ( int j=0; j<lengths[i]; j++ ) {
+                shards[i][j] = (j * (i + 1)) / 5 - 100;
+            }
+        }
+        int n = join_length(lengths, k);
+        int * sequential = (int *) malloc(n * sizeof(int)),
+            * parallel = (int *) malloc(n * sizeof(int));
+        merge_into((const int * const *) shards, lengths, k, sequential);
+        for ( int i=1; i<n; i++ ) {
+            ASSERT_LE(sequential[i-1], sequential[i]);
+        }
+        for ( int threads=2; threads<=5; threads++ ) {
+            ASSERT_EQ(merge_into_parallel((const int * const *) shards, lengths, k, parallel, threads), n);
+            ASSERT_EQ(memcmp(sequential, parallel, n * sizeof(int)), 0);
+        }
+        for ( int i=0; i<k; i++ ) {
+            free(shards[i]);
+        }
+        free(sequential);
+        free(parallel);
+    }
+
 }
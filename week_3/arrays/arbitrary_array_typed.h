@@ -0,0 +1,85 @@
+#ifndef _ARBITRARY_ARRAY_TYPED
+#define _ARBITRARY_ARRAY_TYPED
+
+#include <assert.h>
+#include "arbitrary_array.h"
+
+/*! @file
+ *  Generates arrays specialised to one element type on top of ArbitraryArray.
+ *  Writing
+ *
+ *      ARBITRARY_ARRAY_DEFINE(PointArray, Point)
+ *
+ *  at file scope defines the type PointArray and the inline functions
+ *
+ *      PointArray * PointArray_new(void);
+ *      void PointArray_destroy(PointArray *);
+ *      int PointArray_size(const PointArray *);
+ *      Point PointArray_get(const PointArray *, int);   (index must be < size)
+ *      Point * PointArray_get_ptr(const PointArray *, int);
+ *      void PointArray_set(PointArray *, int, Point);
+ *      void PointArray_push(PointArray *, Point);
+ *      Point * PointArray_data(const PointArray *);
+ *      ArbitraryArray * PointArray_arbitrary(PointArray *);
+ *
+ *  Accessors compile to typed loads and stores with the element size known at
+ *  compile time, instead of calls that memcpy element_size bytes. A typed
+ *  array is laid out exactly as an ArbitraryArray, and _arbitrary returns it
+ *  as one, so it can still be passed to any ArbitraryArray function. Only
+ *  growing the buffer goes through ArbitraryArray itself.
+ */
+
+#define ARBITRARY_ARRAY_DEFINE(Name, Type)                                           \
+                                                                                     \
+typedef struct {                                                                     \
+    ArbitraryArray base;                                                             \
+} Name;                                                                              \
+                                                                                     \
+static inline Name * Name##_new(void) {                                              \
+    return (Name *) ArbitraryArray_new(sizeof(Type));                                \
+}                                                                                    \
+                                                                                     \
+static inline void Name##_destroy(Name * a) {                                        \
+    ArbitraryArray_destroy(&a->base);                                                \
+}                                                                                    \
+                                                                                     \
+static inline ArbitraryArray * Name##_arbitrary(Name * a) {                          \
+    return &a->base;                                                                 \
+}                                                                                    \
+                                                                                     \
+static inline Type * Name##_data(const Name * a) {                                   \
+    return (Type *) ( a->base.buffer + a->base.origin );                             \
+}                                                                                    \
+                                                                                     \
+static inline int Name##_size(const Name * a) {                                      \
+    return ( a->base.end - a->base.origin ) / (int) sizeof(Type);                    \
+}                                                                                    \
+                                                                                     \
+static inline Type Name##_get(const Name * a, int index) {                           \
+    assert(0 <= index && index < Name##_size(a));                                    \
+    return Name##_data(a)[index];                                                    \
+}                                                                                    \
+                                                                                     \
+static inline Type * Name##_get_ptr(const Name * a, int index) {                     \
+    assert(index >= 0);                                                              \
+    return index < Name##_size(a) ? Name##_data(a) + index : (Type *) 0;             \
+}                                                                                    \
+                                                                                     \
+static inline void Name##_set(Name * a, int index, Type value) {                     \
+    assert(index >= 0);                                                              \
+    int offset = a->base.origin + index * (int) sizeof(Type);                        \
+    if ( offset >= a->base.capacity * (int) sizeof(Type) ) {                         \
+        ArbitraryArray_set_from_ptr(&a->base, index, &value);                        \
+        return;                                                                      \
+    }                                                                                \
+    *(Type *) ( a->base.buffer + offset ) = value;                                   \
+    if ( offset >= a->base.end ) {                                                   \
+        a->base.end = offset + (int) sizeof(Type);                                   \
+    }                                                                                \
+}                                                                                    \
+                                                                                     \
+static inline void Name##_push(Name * a, Type value) {                               \
+    Name##_set(a, Name##_size(a), value);                                            \
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynamic_array.h"
+
+/* Compares making and destroying 1M short lived arrays of 16 elements on the
+   heap, one by one, with making them in an arena that is reset in batches of
+   10000. Build and run with make bench. */
+
+#define N 1000000
+#define BATCH 10000
+#define SIZE 16
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static double fill ( DynamicArray * da ) {
+    for ( int j=0; j<SIZE; j++ ) {
+        DynamicArray_push(da, j);
+    }
+    return DynamicArray_sum(da);
+}
+
+int main ( void ) {
+
+    static DynamicArray * arrays[BATCH];
+    double check = 0;
+
+    double t0 = seconds();
+    for ( int i=0; i<N; i += BATCH ) {
+        for ( int k=0; k<BATCH; k++ ) {
+            arrays[k] = DynamicArray_new();
+            check += fill(arrays[k]);
+        }
+        for ( int k=0; k<BATCH; k++ ) {
+            DynamicArray_destroy(arrays[k]);
+            free(arrays[k]);
+        }
+    }
+    printf("heap     %10.2f ms   (%g)\n", 1e3 * (seconds() - t0), check);
+
+    check = 0;
+    t0 = seconds();
+    DynamicArrayArena * arena = DynamicArrayArena_new(0);
+    for ( int i=0; i<N; i += BATCH ) {
+        for ( int k=0; k<BATCH; k++ ) {
+            arrays[k] = DynamicArray_new_in(arena);
+            check += fill(arrays[k]);
+        }
+        DynamicArrayArena_reset(arena);
+    }
+    DynamicArrayArena_destroy(arena);
+    printf("arena    %10.2f ms   (%g)\n", 1e3 * (seconds() - t0), check);
+
+    return 0;
+
+}
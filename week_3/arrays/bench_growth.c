@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynamic_array.h"
+
+/* Measures the cost per element of growing arrays by pushing at the back,
+   pushing at the front, and setting random indices, for 1e3 to 1e8 elements.
+   Build and run with make bench. */
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+/* Simple xorshift generator, so the benchmark does not measure rand() */
+static unsigned int next_random ( unsigned int * state ) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static double push ( int n ) {
+    DynamicArray * da = DynamicArray_new();
+    double t0 = seconds();
+    for ( int i=0; i<n; i++ ) {
+        DynamicArray_push(da, i);
+    }
+    double t = seconds() - t0;
+    DynamicArray_destroy(da);
+    free(da);
+    return t;
+}
+
+static double push_front ( int n ) {
+    DynamicArray * da = DynamicArray_new();
+    double t0 = seconds();
+    for ( int i=0; i<n; i++ ) {
+        DynamicArray_push_front(da, i);
+    }
+    double t = seconds() - t0;
+    DynamicArray_destroy(da);
+    free(da);
+    return t;
+}
+
+static double random_set ( int n ) {
+    DynamicArray * da = DynamicArray_new();
+    unsigned int state = 2463534242u;
+    double t0 = seconds();
+    for ( int i=0; i<n; i++ ) {
+        DynamicArray_set(da, next_random(&state) % n, i);
+    }
+    double t = seconds() - t0;
+    DynamicArray_destroy(da);
+    free(da);
+    return t;
+}
+
+static void run ( const char * name, double (*f) (int) ) {
+    for ( int n = 1000; n <= 100000000; n *= 10 ) {
+        int reps = n < 1000000 ? 1000000 / n : 1;
+        double t = 0;
+        for ( int r=0; r<reps; r++ ) {
+            t += f(n);
+        }
+        printf("%-12s %10d %10.2f ns/element\n", name, n, 1e9 * t / reps / n);
+    }
+}
+
+int main ( void ) {
+    run("push", push);
+    run("push_front", push_front);
+    run("random_set", random_set);
+    return 0;
+}
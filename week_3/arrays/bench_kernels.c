@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include "dynamic_array.h"
+
+/* Compares the per-element API (DynamicArray_get / DynamicArray_set) with
+   the bulk kernels on a 10M element array. Build with make bench. */
+
+#define N 10000000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static double twice ( double x ) {
+    return 2 * x;
+}
+
+static void report ( const char * name, double per_element, double bulk, double check ) {
+    printf("%-8s %12.2f %12.2f %9.1fx   (%g)\n", 
+        name, 1e3 * per_element, 1e3 * bulk, per_element / bulk, check);
+}
+
+int main ( void ) {
+
+    DynamicArray * x = DynamicArray_new(),
+                 * y = DynamicArray_new();
+
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(x, sin(0.001 * i));
+        DynamicArray_push(y, cos(0.001 * i));
+    }
+
+    printf("%-8s %12s %12s %10s\n", "op", "get/set ms", "bulk ms", "speedup");
+
+    double t0, t1, t2, r = 0;
+
+    t0 = seconds();
+    r = 0;
+    for ( int i=0; i<N; i++ ) r += DynamicArray_get(x, i);
+    t1 = seconds();
+    r -= DynamicArray_sum(x);
+    t2 = seconds();
+    report("sum", t1 - t0, t2 - t1, r);
+
+    t0 = seconds();
+    r = DynamicArray_get(x, 0);
+    for ( int i=1; i<N; i++ ) if ( DynamicArray_get(x, i) < r ) r = DynamicArray_get(x, i);
+    t1 = seconds();
+    r -= DynamicArray_min(x);
+    t2 = seconds();
+    report("min", t1 - t0, t2 - t1, r);
+
+    t0 = seconds();
+    r = DynamicArray_get(x, 0);
+    for ( int i=1; i<N; i++ ) if ( DynamicArray_get(x, i) > r ) r = DynamicArray_get(x, i);
+    t1 = seconds();
+    r -= DynamicArray_max(x);
+    t2 = seconds();
+    report("max", t1 - t0, t2 - t1, r);
+
+    t0 = seconds();
+    r = 0;
+    for ( int i=0; i<N; i++ ) r += DynamicArray_get(x, i) * DynamicArray_get(y, i);
+    t1 = seconds();
+    r -= DynamicArray_dot(x, y);
+    t2 = seconds();
+    report("dot", t1 - t0, t2 - t1, r);
+
+    t0 = seconds();
+    DynamicArray * a = DynamicArray_map(x, twice);
+    t1 = seconds();
+    DynamicArray * b = DynamicArray_map_op(x, DYNAMIC_ARRAY_MUL, 2);
+    t2 = seconds();
+    report("map", t1 - t0, t2 - t1, DynamicArray_get(a, N-1) - DynamicArray_get(b, N-1));
+
+    t0 = seconds();
+    for ( int i=0; i<N; i++ ) DynamicArray_set(a, i, 0.5 * DynamicArray_get(x, i) + DynamicArray_get(a, i));
+    t1 = seconds();
+    DynamicArray_axpy(0.5, x, b);
+    t2 = seconds();
+    report("axpy", t1 - t0, t2 - t1, DynamicArray_get(a, N-1) - DynamicArray_get(b, N-1));
+
+    DynamicArray_destroy(x);
+    DynamicArray_destroy(y);
+    DynamicArray_destroy(a);
+    DynamicArray_destroy(b);
+
+    return 0;
+
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "dynamic_array.h"
+#include "dynamic_array_writer.h"
+
+/* Compares persisting 20M doubles as text and parsing them back with strtod
+   against pushing them to a memory-mapped array file and mapping it again.
+   Files go in /tmp and are removed. Build and run with make bench. */
+
+#define N 20000000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+int main ( void ) {
+
+    const char * text_path = "/tmp/bench_mapped.txt",
+               * mapped_path = "/tmp/bench_mapped.dat";
+    unlink(mapped_path);
+
+    DynamicArray * da = DynamicArray_new();
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(da, i * 0.001);
+    }
+
+    /* Text */
+    double t0 = seconds();
+    FILE * f = fopen(text_path, "w");
+    static char chunk[1 << 16];
+    DynamicArrayWriter w = DynamicArrayWriter_to_file(f, chunk, sizeof(chunk));
+    DynamicArray_write(da, &w);
+    DynamicArrayWriter_finish(&w);
+    fclose(f);
+    double t_save = seconds() - t0;
+
+    t0 = seconds();
+    f = fopen(text_path, "r");
+    DynamicArray * loaded = DynamicArray_new();
+    char number[64];
+    fgetc(f); /* [ */
+    while ( fscanf(f, "%63[^,]]", number) == 1 ) {
+        DynamicArray_push(loaded, strtod(number, NULL));
+        if ( fgetc(f) != ',' ) {
+            break;
+        }
+    }
+    fclose(f);
+    double sum = DynamicArray_sum(loaded);
+    printf("text     save %8.2f ms   load+sum %8.2f ms   (%g)\n", 1e3 * t_save, 1e3 * (seconds() - t0), sum);
+    DynamicArray_destroy(loaded);
+    free(loaded);
+
+    /* Mapped */
+    t0 = seconds();
+    DynamicArray * mapped = DynamicArray_open_mapped(mapped_path);
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(mapped, DynamicArray_get(da, i));
+    }
+    DynamicArray_destroy(mapped);
+    free(mapped);
+    t_save = seconds() - t0;
+
+    t0 = seconds();
+    mapped = DynamicArray_open_mapped(mapped_path);
+    sum = DynamicArray_sum(mapped);
+    printf("mapped   save %8.2f ms   load+sum %8.2f ms   (%g)\n", 1e3 * t_save, 1e3 * (seconds() - t0), sum);
+    DynamicArray_destroy(mapped);
+    free(mapped);
+
+    unlink(text_path);
+    unlink(mapped_path);
+    DynamicArray_destroy(da);
+    free(da);
+    return 0;
+
+}
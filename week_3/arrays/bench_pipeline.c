@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynamic_array.h"
+#include "dynamic_array_pipeline.h"
+
+/* Compares a chain of four maps followed by a sum over 10M elements done
+   eagerly, with DynamicArray_map making an array per stage, and lazily, with
+   a fused DynamicArrayPipeline. Build and run with make bench. */
+
+#define N 10000000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static double scale ( double x ) { return 0.5 * x; }
+static double shift ( double x ) { return x - 1.0; }
+static double square ( double x ) { return x * x; }
+static double clip ( double x ) { return x > 100.0 ? 100.0 : x; }
+
+int main ( void ) {
+
+    double (*stages[]) (double) = { scale, shift, square, clip };
+
+    DynamicArray * da = DynamicArray_new();
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(da, i % 1000);
+    }
+
+    double t0 = seconds();
+    DynamicArray * current = da;
+    for ( int j=0; j<4; j++ ) {
+        DynamicArray * next = DynamicArray_map(current, stages[j]);
+        if ( current != da ) {
+            DynamicArray_destroy(current);
+            free(current);
+        }
+        current = next;
+    }
+    double eager = DynamicArray_sum(current);
+    DynamicArray_destroy(current);
+    free(current);
+    double t_eager = seconds() - t0;
+
+    t0 = seconds();
+    DynamicArrayPipeline p = DynamicArray_pipeline(da);
+    for ( int j=0; j<4; j++ ) {
+        DynamicArrayPipeline_map(&p, stages[j]);
+    }
+    double lazy = DynamicArrayPipeline_sum(&p);
+    double t_lazy = seconds() - t0;
+
+    printf("eager    %10.2f ms   (%g)\n", 1e3 * t_eager, eager);
+    printf("fused    %10.2f ms   (%g)\n", 1e3 * t_lazy, lazy);
+
+    DynamicArray_destroy(da);
+    free(da);
+    return 0;
+
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dynamic_array.h"
+#include "quantile_sketch.h"
+
+/* Compares p50/p95/p99 of 10M samples computed by sorting a copy, by
+   selection with DynamicArray_quantiles, and by streaming P-square sketches.
+   Build and run with make bench. */
+
+#define N 10000000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static int compare ( const void * a, const void * b ) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return x < y ? -1 : x > y;
+}
+
+static void report ( const char * name, double t, const double * q ) {
+    printf("%-10s %10.2f ms   p50 %.4f  p95 %.4f  p99 %.4f\n", name, 1e3 * t, q[0], q[1], q[2]);
+}
+
+int main ( void ) {
+
+    double ps[] = { 0.5, 0.95, 0.99 }, q[3];
+
+    DynamicArray * da = DynamicArray_new();
+    srand(0);
+    for ( int i=0; i<N; i++ ) {
+        /* skewed, like latencies */
+        double u = (double) rand() / RAND_MAX;
+        DynamicArray_push(da, u * u * u);
+    }
+
+    double t0 = seconds();
+    double * copy = (double *) malloc(N * sizeof(double));
+    memcpy(copy, da->buffer + da->origin, N * sizeof(double));
+    qsort(copy, N, sizeof(double), compare);
+    for ( int i=0; i<3; i++ ) {
+        double h = (N - 1) * ps[i];
+        int k = (int) h;
+        q[i] = copy[k] + (h - k) * (copy[k+1] - copy[k]);
+    }
+    free(copy);
+    report("sort", seconds() - t0, q);
+
+    t0 = seconds();
+    DynamicArray_quantiles(da, ps, 3, q);
+    report("select", seconds() - t0, q);
+
+    t0 = seconds();
+    for ( int i=0; i<3; i++ ) {
+        QuantileSketch * s = QuantileSketch_new(ps[i]);
+        QuantileSketch_add_array(s, da);
+        q[i] = QuantileSketch_get(s);
+        QuantileSketch_destroy(s);
+    }
+    report("P-square", seconds() - t0, q);
+
+    DynamicArray_destroy(da);
+    free(da);
+    return 0;
+
+}
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "arbitrary_array.h"
+#include "arbitrary_array_typed.h"
+
+/* Compares filling, overwriting and scanning 10M small records through the
+   generic ArbitraryArray interface and through an array generated with
+   ARBITRARY_ARRAY_DEFINE. Filling is dominated by ArbitraryArray's buffer
+   growth, which both share; overwriting and scanning show the cost of the
+   accessors themselves. Build and run with make bench. */
+
+#define N 10000000
+
+typedef struct {
+    double time;
+    float x, y, z;
+    int sensor;
+} Record;
+
+ARBITRARY_ARRAY_DEFINE(RecordArray, Record)
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+static Record record ( int i ) {
+    Record r = { 0.001 * i, (float) i, 0.5f, -0.5f, i % 16 };
+    return r;
+}
+
+int main ( void ) {
+
+    double t0 = seconds();
+    ArbitraryArray * generic = ArbitraryArray_new(sizeof(Record));
+    for ( int i=0; i<N; i++ ) {
+        Record r = record(i);
+        ArbitraryArray_set_from_ptr(generic, i, &r);
+    }
+    double t_fill = seconds() - t0;
+    t0 = seconds();
+    for ( int i=0; i<N; i++ ) {
+        Record r = record(N - i);
+        ArbitraryArray_set_from_ptr(generic, i, &r);
+    }
+    double t_update = seconds() - t0;
+    t0 = seconds();
+    double sum = 0;
+    for ( int i=0; i<N; i++ ) {
+        Record * r = (Record *) ArbitraryArray_get_ptr(generic, i);
+        sum += r->time * r->x;
+    }
+    printf("generic  fill %8.2f ms   overwrite %8.2f ms   scan %8.2f ms   (%g)\n",
+           1e3 * t_fill, 1e3 * t_update, 1e3 * (seconds() - t0), sum);
+    ArbitraryArray_destroy(generic);
+    free(generic);
+
+    t0 = seconds();
+    RecordArray * typed = RecordArray_new();
+    for ( int i=0; i<N; i++ ) {
+        RecordArray_set(typed, i, record(i));
+    }
+    t_fill = seconds() - t0;
+    t0 = seconds();
+    for ( int i=0; i<N; i++ ) {
+        RecordArray_set(typed, i, record(N - i));
+    }
+    t_update = seconds() - t0;
+    t0 = seconds();
+    sum = 0;
+    for ( int i=0; i<N; i++ ) {
+        Record r = RecordArray_get(typed, i);
+        sum += r.time * r.x;
+    }
+    printf("typed    fill %8.2f ms   overwrite %8.2f ms   scan %8.2f ms   (%g)\n",
+           1e3 * t_fill, 1e3 * t_update, 1e3 * (seconds() - t0), sum);
+    RecordArray_destroy(typed);
+    free(typed);
+
+    return 0;
+
+}
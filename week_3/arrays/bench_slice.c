@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dynamic_array.h"
+#include "dynamic_array_slice.h"
+
+/* Compares the mean of 100k sliding windows of 1000 elements computed with
+   DynamicArray_subarray, which copies each window, and with slices, which do
+   not. Build and run with make bench. */
+
+#define N 1000000
+#define WINDOW 1000
+#define WINDOWS 100000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+int main ( void ) {
+
+    DynamicArray * da = DynamicArray_new();
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(da, i % 97);
+    }
+
+    double check = 0, t0 = seconds();
+    for ( int i=0; i<WINDOWS; i++ ) {
+        DynamicArray * w = DynamicArray_subarray(da, i, i + WINDOW);
+        check += DynamicArray_mean(w);
+        DynamicArray_destroy(w);
+        free(w);
+    }
+    printf("subarray %10.2f ms   (%g)\n", 1e3 * (seconds() - t0), check);
+
+    check = 0;
+    t0 = seconds();
+    for ( int i=0; i<WINDOWS; i++ ) {
+        check += DynamicArraySlice_mean(DynamicArray_slice(da, i, i + WINDOW, 1));
+    }
+    printf("slice    %10.2f ms   (%g)\n", 1e3 * (seconds() - t0), check);
+
+    DynamicArray_destroy(da);
+    free(da);
+    return 0;
+
+}
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include "dynamic_array.h"
+
+/* Google Benchmark suite for DynamicArray push, get and sum throughput. Run
+   it with make json to write the results to bench_suite.json, which can be
+   compared between commits. It is also run, with console output, by make
+   bench. */
+
+namespace {
+
+    void BM_Push(benchmark::State& state) {
+        for ( auto _ : state ) {
+            DynamicArray * da = DynamicArray_new();
+            for ( int i=0; i<state.range(0); i++ ) {
+                DynamicArray_push(da, i);
+            }
+            benchmark::DoNotOptimize(DynamicArray_size(da));
+            DynamicArray_destroy(da);
+            free(da);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Push)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+    void BM_Get(benchmark::State& state) {
+        DynamicArray * da = DynamicArray_new();
+        for ( int i=0; i<state.range(0); i++ ) {
+            DynamicArray_push(da, i);
+        }
+        for ( auto _ : state ) {
+            double total = 0;
+            for ( int i=0; i<state.range(0); i++ ) {
+                total += DynamicArray_get(da, i);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        DynamicArray_destroy(da);
+        free(da);
+    }
+    BENCHMARK(BM_Get)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+    void BM_Sum(benchmark::State& state) {
+        DynamicArray * da = DynamicArray_new();
+        for ( int i=0; i<state.range(0); i++ ) {
+            DynamicArray_push(da, i);
+        }
+        for ( auto _ : state ) {
+            benchmark::DoNotOptimize(DynamicArray_sum(da));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        DynamicArray_destroy(da);
+        free(da);
+    }
+    BENCHMARK(BM_Sum)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+}
+
+BENCHMARK_MAIN();
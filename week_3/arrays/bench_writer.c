@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dynamic_array.h"
+#include "dynamic_array_writer.h"
+
+/* Compares dumping 10M doubles with snprintf("%.17g") per element into a
+   string sized up front, as the old DynamicArray_to_string did, against the
+   Grisu2 writer streaming to /dev/null through a 64KB chunk, and against
+   DynamicArray_to_string. Build and run with make bench. */
+
+#define N 10000000
+
+static double seconds ( void ) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+int main ( void ) {
+
+    DynamicArray * da = DynamicArray_new();
+    srand(0);
+    for ( int i=0; i<N; i++ ) {
+        DynamicArray_push(da, (double) rand() / RAND_MAX * 1000);
+    }
+    const double * x = da->buffer + da->origin;
+
+    double t0 = seconds();
+    char * str = (char *) calloc(25, N), temp[25];
+    int j = 1;
+    str[0] = '[';
+    for ( int i=0; i<N; i++ ) {
+        snprintf(temp, 25, "%.17g", x[i]);
+        sprintf(str + j, i < N - 1 ? "%s," : "%s", temp);
+        j += strlen(temp) + ( i < N - 1 );
+    }
+    str[j++] = ']';
+    printf("snprintf   %10.2f ms   %d bytes, %d MB allocated\n", 1e3 * (seconds() - t0), j, 25 * N >> 20);
+    free(str);
+
+    FILE * f = fopen("/dev/null", "w");
+    static char chunk[1 << 16];
+    t0 = seconds();
+    DynamicArrayWriter w = DynamicArrayWriter_to_file(f, chunk, sizeof(chunk));
+    DynamicArray_write(da, &w);
+    long n = DynamicArrayWriter_finish(&w);
+    printf("writer     %10.2f ms   %ld bytes, %d KB chunk\n", 1e3 * (seconds() - t0), n, (int) sizeof(chunk) >> 10);
+    fclose(f);
+
+    t0 = seconds();
+    str = DynamicArray_to_string(da);
+    printf("to_string  %10.2f ms   %d bytes\n", 1e3 * (seconds() - t0), (int) strlen(str));
+    free(str);
+
+    DynamicArray_destroy(da);
+    free(da);
+    return 0;
+
+}
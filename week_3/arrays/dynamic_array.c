@@ -1,11 +1,42 @@
 #include "dynamic_array.h"
-#include "arbitrary_array.h"
+#include "dynamic_array_slice.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
-
-static ArbitraryArray * ptrs = ArbitraryArray_new(sizeof(DynamicArray *));
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Number of arrays constructed and not yet destroyed, whether on the heap or
+   in an arena */
+static int num_arrays = 0;
+
+/* Arena chunks start with this header, padded so that the memory after it
+   is aligned like the chunk itself */
+struct DynamicArrayArenaChunk {
+    DynamicArrayArenaChunk * next;
+    size_t size, used;
+};
+
+#define CHUNK_HEADER DYNAMIC_ARRAY_ALIGNMENT
+
+/* An open, mapped array file. base points at the file header. */
+struct DynamicArrayMapping {
+    int fd;
+    char * base;
+    size_t size;
+};
+
+/* The start of an array file */
+typedef struct {
+    char magic[8];
+    int64_t capacity,
+            origin,
+            end;
+} FileHeader;
 
 /* private functions *********************************************************/
 
@@ -19,61 +50,360 @@ static int offset_to_index ( const DynamicArray * da, int offset ) {
     return offset - da->origin;
 }
 
-/* Non-zero if and only if offset lies ouside the buffer */
-static int out_of_buffer ( DynamicArray * da, int offset ) {
-    return offset < 0 || offset >= da->capacity;
+/* size bytes aligned to DYNAMIC_ARRAY_ALIGNMENT, from the heap */
+static void * aligned_alloc_or_exit ( size_t size ) {
+    void * ptr = NULL;
+    if ( posix_memalign(&ptr, DYNAMIC_ARRAY_ALIGNMENT, size) != 0 ) {
+        printf("DynamicArray could not allocate %zu bytes\n", size);
+        exit(1);
+    }
+    return ptr;
 }
 
-/* Makes a new buffer that is twice the size of the old buffer,
-   copies the old information into the new buffer, and deletes
-   the old buffer */
-static void extend_buffer ( DynamicArray * da ) {
+/* First free byte of the current chunk of the arena */
+static char * arena_top ( const DynamicArrayArena * arena ) {
+    return (char *) arena->chunks + CHUNK_HEADER + arena->chunks->used;
+}
 
-    double * temp = (double *) calloc ( 2 * da->capacity, sizeof(double) );
-    int new_origin = da->capacity - (da->end - da->origin)/2,
-           new_end = new_origin + (da->end - da->origin);
+/* size bytes from the arena with the given alignment, starting a new chunk
+   when the current one is full. Nothing is ever freed individually. */
+static void * arena_alloc ( DynamicArrayArena * arena, size_t size, size_t alignment ) {
+    DynamicArrayArenaChunk * chunk = arena->chunks;
+    size_t start = chunk ? ( chunk->used + alignment - 1 ) / alignment * alignment : 0;
+    if ( chunk == NULL || start + size > chunk->size ) {
+        size_t chunk_size = size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = (DynamicArrayArenaChunk *) aligned_alloc_or_exit(CHUNK_HEADER + chunk_size);
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        arena->chunks = chunk;
+        start = 0;
+    }
+    chunk->used = start + size;
+    return (char *) chunk + CHUNK_HEADER + start;
+}
 
-    for ( int i=0; i<DynamicArray_size(da); i++ ) {
-        temp[new_origin+i] = DynamicArray_get(da,i);
+/* Grows the block of old_size bytes at ptr to new_size bytes in place, which
+   is possible when it is the last block taken from the arena and the chunk
+   has room. Returns 1 on success, 0 otherwise. */
+static int arena_extend ( DynamicArrayArena * arena, void * ptr, size_t old_size, size_t new_size ) {
+    DynamicArrayArenaChunk * chunk = arena->chunks;
+    if ( chunk == NULL || (char *) ptr + old_size != arena_top(arena) ||
+         chunk->used - old_size + new_size > chunk->size ) {
+        return 0;
     }
+    chunk->used = chunk->used - old_size + new_size;
+    return 1;
+}
 
-    free(da->buffer);
-    da->buffer = temp;
+/* An uninitialized buffer of capacity doubles, aligned to DYNAMIC_ARRAY_ALIGNMENT,
+   from the arena if there is one and from the heap otherwise */
+static double * allocate_buffer ( DynamicArrayArena * arena, int capacity ) {
+    if ( arena ) {
+        return (double *) arena_alloc(arena, capacity * sizeof(double), DYNAMIC_ARRAY_ALIGNMENT);
+    }
+    return (double *) aligned_alloc_or_exit(capacity * sizeof(double));
+}
+
+/* Releases the buffer. Buffers in an arena are reclaimed with the arena. */
+static void free_buffer ( DynamicArray * da ) {
+    if ( da->arena == NULL ) {
+        free(da->buffer);
+    }
+}
+
+/* Pointer to the first element */
+static double * begin ( const DynamicArray * da ) {
+    return da->buffer + da->origin;
+}
+
+/* Bytes in an array file holding capacity doubles */
+static size_t file_size ( int capacity ) {
+    return DYNAMIC_ARRAY_FILE_HEADER + (size_t) capacity * sizeof(double);
+}
+
+/* Sets the size of the mapped file and maps it again, possibly at a new address */
+static void resize_mapping ( DynamicArrayMapping * m, size_t size ) {
+    munmap(m->base, m->size);
+    void * base = MAP_FAILED;
+    if ( ftruncate(m->fd, size) == 0 ) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+    }
+    if ( base == MAP_FAILED ) {
+        printf("DynamicArray could not map %zu bytes\n", size);
+        exit(1);
+    }
+    m->base = (char *) base;
+    m->size = size;
+}
 
-    da->capacity = 2 * da->capacity;
+static void write_header ( const DynamicArray * da ) {
+    FileHeader * header = (FileHeader *) da->mapping->base;
+    memcpy(header->magic, DYNAMIC_ARRAY_FILE_MAGIC, sizeof(header->magic));
+    header->capacity = da->capacity;
+    header->origin = da->origin;
+    header->end = da->end;
+}
+
+/* relocate for mapped arrays: the file is resized and the elements moved
+   within it, shifting them before shrinking the file and after growing it */
+static void relocate_mapped ( DynamicArray * da, int new_capacity, int new_origin ) {
+    int size = DynamicArray_size(da);
+    DynamicArrayMapping * m = da->mapping;
+    size_t new_size = file_size(new_capacity);
+    if ( new_size < m->size ) {
+        memmove(da->buffer + new_origin, da->buffer + da->origin, size * sizeof(double));
+        resize_mapping(m, new_size);
+    } else {
+        resize_mapping(m, new_size);
+        double * buffer = (double *) ( m->base + DYNAMIC_ARRAY_FILE_HEADER );
+        memmove(buffer + new_origin, buffer + da->origin, size * sizeof(double));
+    }
+    da->buffer = (double *) ( m->base + DYNAMIC_ARRAY_FILE_HEADER );
+    da->capacity = new_capacity;
     da->origin = new_origin;
-    da->end = new_end;
+    da->end = new_origin + size;
+    write_header(da);
+}
 
-    return;
+/* Moves the elements into a buffer of new_capacity doubles, with the first
+   element at new_origin. Only the live elements are copied and nothing is
+   zeroed. When the elements stay put, the buffer is extended in place if
+   possible: with realloc on the heap, or by bumping the top of the arena. */
+static void relocate ( DynamicArray * da, int new_capacity, int new_origin ) {
+
+    int size = DynamicArray_size(da);
+
+    if ( da->mapping ) {
+        relocate_mapped(da, new_capacity, new_origin);
+        return;
+    }
+
+    if ( new_origin == da->origin && da->arena != NULL ) {
+        if ( arena_extend(da->arena, da->buffer, da->capacity * sizeof(double), new_capacity * sizeof(double)) ) {
+            da->capacity = new_capacity;
+            return;
+        }
+    } else if ( new_origin == da->origin ) {
+        double * temp = (double *) realloc(da->buffer, new_capacity * sizeof(double));
+        if ( temp == NULL ) {
+            printf("DynamicArray could not allocate %d elements\n", new_capacity);
+            exit(1);
+        }
+        da->buffer = temp;
+        if ( (size_t) temp % DYNAMIC_ARRAY_ALIGNMENT == 0 ) {
+            da->capacity = new_capacity;
+            return;
+        }
+        /* realloc only guarantees malloc's alignment, so copy into an aligned buffer */
+    }
+
+    double * temp = allocate_buffer(da->arena, new_capacity);
+    memcpy(temp + new_origin, begin(da), size * sizeof(double));
+    free_buffer(da);
+
+    da->buffer = temp;
+    da->capacity = new_capacity;
+    da->origin = new_origin;
+    da->end = new_origin + size;
 
 }
 
-/* public functions **********************************************************/
+/* Makes room for at least min_capacity - capacity more elements at the back,
+   at least doubling the capacity so that pushes are amortized O(1). The room
+   in front of the elements is unchanged. */
+static void grow_back ( DynamicArray * da, int min_capacity ) {
+    int new_capacity = 2 * da->capacity;
+    if ( new_capacity < min_capacity ) {
+        new_capacity = min_capacity;
+    }
+    relocate(da, new_capacity, da->origin);
+}
 
-DynamicArray * DynamicArray_new(void) {
-    DynamicArray * da = (DynamicArray *) malloc(sizeof(DynamicArray));
-    da->capacity = DYNAMIC_ARRAY_INITIAL_CAPACITY;    
-    da->buffer = (double *) calloc ( da->capacity, sizeof(double) ); 
-    da->origin = da->capacity / 2;
-    da->end = da->origin;
-
-    int n = ArbitraryArray_size(ptrs);
-    ArbitraryArray_set_from_ptr(ptrs, n, &da);
-    DynamicArray ** ptr = (DynamicArray **) ArbitraryArray_get_ptr(ptrs,n);
-    printf("%x, %x\n", da, *ptr);
-    printf("%x, %x, %x\n", da, *ptr, ptr);
-    if ( da == *ptr ) {
-        printf("YAY\n");
+/* Makes room in front of the elements, as much as there are elements, so that
+   pushes to the front are amortized O(1). The room at the back is unchanged. */
+static void grow_front ( DynamicArray * da ) {
+    int room = DynamicArray_size(da);
+    if ( room < DYNAMIC_ARRAY_INITIAL_CAPACITY ) {
+        room = DYNAMIC_ARRAY_INITIAL_CAPACITY;
+    }
+    relocate(da, da->capacity + room, da->origin + room);
+}
+
+/* A new empty array with the given capacity and origin, in the arena if
+   there is one */
+static DynamicArray * construct ( DynamicArrayArena * arena, int capacity, int origin ) {
+    DynamicArray * da = arena
+      ? (DynamicArray *) arena_alloc(arena, sizeof(DynamicArray), sizeof(void *))
+      : (DynamicArray *) malloc(sizeof(DynamicArray));
+    da->capacity = capacity;
+    da->buffer = allocate_buffer(arena, capacity);
+    da->origin = origin;
+    da->end = origin;
+    da->arena = arena;
+    da->mapping = NULL;
+    num_arrays++;
+    if ( arena ) {
+        arena->num_arrays++;
     }
     return da;
 }
 
+/* A new array with size elements, allocated once, with room to grow at both ends,
+   in the arena if there is one. The caller is expected to fill in the elements. */
+static DynamicArray * new_of_size ( DynamicArrayArena * arena, int size ) {
+    DynamicArray * da = size > DYNAMIC_ARRAY_INITIAL_CAPACITY / 2
+      ? construct(arena, 2 * size, size / 2)
+      : construct(arena, DYNAMIC_ARRAY_INITIAL_CAPACITY, DYNAMIC_ARRAY_INITIAL_CAPACITY / 2);
+    da->end = da->origin + size;
+    return da;
+}
+
+/* public functions **********************************************************/
+
+DynamicArray * DynamicArray_new(void) {
+    return construct(NULL, DYNAMIC_ARRAY_INITIAL_CAPACITY, DYNAMIC_ARRAY_INITIAL_CAPACITY / 2);
+}
+
+DynamicArray * DynamicArray_new_in(DynamicArrayArena * arena) {
+    return construct(arena, DYNAMIC_ARRAY_INITIAL_CAPACITY, DYNAMIC_ARRAY_INITIAL_CAPACITY / 2);
+}
+
 void DynamicArray_destroy(DynamicArray * da) {
-    free(da->buffer);
+    if ( da->buffer == NULL ) {
+        return;
+    }
+    if ( da->mapping ) {
+        write_header(da);
+        munmap(da->mapping->base, da->mapping->size);
+        close(da->mapping->fd);
+        free(da->mapping);
+        da->mapping = NULL;
+    } else {
+        free_buffer(da);
+    }
     da->buffer = NULL;
+    num_arrays--;
+    if ( da->arena ) {
+        da->arena->num_arrays--;
+    }
     return;
 }
 
+int DynamicArray_is_valid(const DynamicArray * da) {
+    return da->buffer != NULL;
+}
+
+int DynamicArray_num_arrays() {
+    return num_arrays;
+}
+
+/* Memory-mapped arrays ******************************************************/
+
+DynamicArray * DynamicArray_open_mapped(const char * path) {
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if ( fd < 0 || fstat(fd, &st) != 0 ) {
+        if ( fd >= 0 ) {
+            close(fd);
+        }
+        return NULL;
+    }
+
+    /* A new file gets the layout of DynamicArray_new */
+    int fresh = st.st_size == 0;
+    size_t size = fresh ? file_size(DYNAMIC_ARRAY_INITIAL_CAPACITY) : (size_t) st.st_size;
+    void * base = MAP_FAILED;
+    if ( size >= DYNAMIC_ARRAY_FILE_HEADER && ( !fresh || ftruncate(fd, size) == 0 ) ) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if ( base == MAP_FAILED ) {
+        close(fd);
+        return NULL;
+    }
+
+    FileHeader * header = (FileHeader *) base;
+    if ( fresh ) {
+        memcpy(header->magic, DYNAMIC_ARRAY_FILE_MAGIC, sizeof(header->magic));
+        header->capacity = DYNAMIC_ARRAY_INITIAL_CAPACITY;
+        header->origin = header->end = DYNAMIC_ARRAY_INITIAL_CAPACITY / 2;
+    }
+    if ( memcmp(header->magic, DYNAMIC_ARRAY_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+         header->capacity <= 0 || header->capacity > INT32_MAX ||
+         file_size(header->capacity) != size ||
+         header->origin < 0 || header->origin > header->end || header->end > header->capacity ) {
+        munmap(base, size);
+        close(fd);
+        return NULL;
+    }
+
+    DynamicArrayMapping * m = (DynamicArrayMapping *) malloc(sizeof(DynamicArrayMapping));
+    m->fd = fd;
+    m->base = (char *) base;
+    m->size = size;
+
+    DynamicArray * da = (DynamicArray *) malloc(sizeof(DynamicArray));
+    da->capacity = (int) header->capacity;
+    da->origin = (int) header->origin;
+    da->end = (int) header->end;
+    da->buffer = (double *) ( m->base + DYNAMIC_ARRAY_FILE_HEADER );
+    da->arena = NULL;
+    da->mapping = m;
+    num_arrays++;
+    return da;
+
+}
+
+void DynamicArray_sync(DynamicArray * da) {
+    assert(da->buffer != NULL);
+    if ( da->mapping ) {
+        write_header(da);
+        msync(da->mapping->base, da->mapping->size, MS_SYNC);
+    }
+}
+
+/* Arenas ********************************************************************/
+
+DynamicArrayArena * DynamicArrayArena_new(size_t chunk_size) {
+    DynamicArrayArena * arena = (DynamicArrayArena *) malloc(sizeof(DynamicArrayArena));
+    arena->chunks = NULL;
+    arena->chunk_size = chunk_size > 0 ? chunk_size : DYNAMIC_ARRAY_ARENA_CHUNK_SIZE;
+    arena->num_arrays = 0;
+    return arena;
+}
+
+void DynamicArrayArena_reset(DynamicArrayArena * arena) {
+    /* Keep the most recent chunk for reuse and give back the rest */
+    DynamicArrayArenaChunk * chunk = arena->chunks;
+    if ( chunk ) {
+        DynamicArrayArenaChunk * rest = chunk->next;
+        while ( rest ) {
+            DynamicArrayArenaChunk * next = rest->next;
+            free(rest);
+            rest = next;
+        }
+        chunk->next = NULL;
+        chunk->used = 0;
+    }
+    num_arrays -= arena->num_arrays;
+    arena->num_arrays = 0;
+}
+
+void DynamicArrayArena_destroy(DynamicArrayArena * arena) {
+    DynamicArrayArenaChunk * chunk = arena->chunks;
+    while ( chunk ) {
+        DynamicArrayArenaChunk * next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    num_arrays -= arena->num_arrays;
+    free(arena);
+}
+
+int DynamicArrayArena_num_arrays(const DynamicArrayArena * arena) {
+    return arena->num_arrays;
+}
+
 int DynamicArray_size(const DynamicArray * da) {
     assert(da->buffer != NULL);
     return da->end - da->origin;
@@ -81,27 +411,7 @@ int DynamicArray_size(const DynamicArray * da) {
 
 char * DynamicArray_to_string(const DynamicArray * da) {
     assert(da->buffer != NULL);
-    char * str = (char *) calloc (20,DynamicArray_size(da)),
-         temp[20];
-    int j = 1;
-    str[0] = '[';
-    for ( int i=0; i < DynamicArray_size(da); i++ ) {
-        if ( DynamicArray_get(da,i) == 0 ) {
-            snprintf ( temp, 20, "0" );
-        } else {
-            snprintf ( temp, 20, "%.5lf", DynamicArray_get(da,i) ); 
-        }
-        if ( i < DynamicArray_size(da) - 1 ) {
-            sprintf( str + j, "%s,", temp);
-            j += strlen(temp) + 1;
-        } else {
-            sprintf( str + j, "%s", temp);
-            j += strlen(temp);
-        }
-
-    }
-    str[j] = ']';
-    return str;
+    return DynamicArraySlice_to_string(DynamicArray_view(da));
 }
 
 void DynamicArray_print_debug_info(const DynamicArray * da) {
@@ -121,14 +431,16 @@ void DynamicArray_print_debug_info(const DynamicArray * da) {
 void DynamicArray_set(DynamicArray * da, int index, double value) {
     assert(da->buffer != NULL);
     assert ( index >= 0 );
-    while ( out_of_buffer(da, index_to_offset(da, index) ) ) {
-        extend_buffer(da);
+    int offset = index_to_offset(da, index);
+    if ( offset >= da->capacity ) {
+        grow_back(da, offset + 1);
     }
-    da->buffer[index_to_offset(da, index)] = value;
-    if ( index >= DynamicArray_size(da) ) {
-        da->end = index_to_offset(da,index+1);
+    if ( offset >= da->end ) {
+        /* Elements skipped over between the old end and index read as zero */
+        memset(da->buffer + da->end, 0, (offset - da->end) * sizeof(double));
+        da->end = offset + 1;
     }
-
+    da->buffer[offset] = value;
 }
 
 double DynamicArray_get(const DynamicArray * da, int index) {
@@ -142,24 +454,24 @@ double DynamicArray_get(const DynamicArray * da, int index) {
 }
 
 void DynamicArray_push(DynamicArray * da, double value ) {
-    DynamicArray_set(da, DynamicArray_size(da), value );
+    assert(da->buffer != NULL);
+    if ( da->end == da->capacity ) {
+        grow_back(da, da->capacity + 1);
+    }
+    da->buffer[da->end++] = value;
 }
 
 void DynamicArray_push_front(DynamicArray * da, double value) {
     assert(da->buffer != NULL);
-    while ( da->origin == 0 ) {
-        extend_buffer(da);
+    if ( da->origin == 0 ) {
+        grow_front(da);
     }
-    da->origin--;
-    DynamicArray_set(da,0,value);
+    da->buffer[--da->origin] = value;
 }
 
 double DynamicArray_pop(DynamicArray * da) {
     assert(DynamicArray_size(da) > 0);
-    double value = DynamicArray_get(da, DynamicArray_size(da)-1);
-    DynamicArray_set(da, DynamicArray_size(da)-1, 0.0);
-    da->end--;
-    return value;
+    return da->buffer[--da->end];
 }
 
 double DynamicArray_pop_front(DynamicArray * da) {
@@ -170,9 +482,13 @@ double DynamicArray_pop_front(DynamicArray * da) {
 }
 
 DynamicArray * DynamicArray_map(const DynamicArray * da, double (*f) (double)) {
-    DynamicArray * result = DynamicArray_new();
-    for ( int i=0; i<DynamicArray_size(da); i++ ) {
-        DynamicArray_set(result, i, f(DynamicArray_get(da, i)));
+    assert(da->buffer != NULL);
+    int n = DynamicArray_size(da);
+    DynamicArray * result = new_of_size(da->arena, n);
+    const double * x = begin(da);
+    double * y = begin(result);
+    for ( int i=0; i<n; i++ ) {
+        y[i] = f(x[i]);
     }
     return result;
 }
@@ -186,12 +502,143 @@ DynamicArray * DynamicArray_subarray(DynamicArray * da, int a, int b) {
       exit(1);
   }
 
-  DynamicArray * result = DynamicArray_new();
+  /* Indices past the end read as zero, as with DynamicArray_get */
+  int size = DynamicArray_size(da),
+      n = b < size ? b - a : ( a < size ? size - a : 0 );
 
-  for (int i=a; i<b; i++) {
-      DynamicArray_push(result,DynamicArray_get(da, i));
-  }
+  DynamicArray * result = new_of_size(da->arena, b - a);
+  memcpy(begin(result), begin(da) + a, n * sizeof(double));
+  memset(begin(result) + n, 0, ( b - a - n ) * sizeof(double));
 
   return result;
 
-}
\ No newline at end of file
+}
+
+DynamicArray * DynamicArray_copy ( const DynamicArray * da ) {
+    assert(da->buffer != NULL);
+    int n = DynamicArray_size(da);
+    DynamicArray * result = new_of_size(da->arena, n);
+    memcpy(begin(result), begin(da), n * sizeof(double));
+    return result;
+}
+
+DynamicArray * DynamicArray_concat ( const DynamicArray * a, const DynamicArray * b ) {
+    assert(a->buffer != NULL && b->buffer != NULL);
+    int na = DynamicArray_size(a),
+        nb = DynamicArray_size(b);
+    DynamicArray * result = new_of_size(a->arena, na + nb);
+    memcpy(begin(result), begin(a), na * sizeof(double));
+    memcpy(begin(result) + na, begin(b), nb * sizeof(double));
+    return result;
+}
+
+void DynamicArray_reserve(DynamicArray * da, int n) {
+    assert(da->buffer != NULL);
+    if ( da->origin + n > da->capacity ) {
+        relocate(da, da->origin + n, da->origin);
+    }
+}
+
+void DynamicArray_shrink_to_fit(DynamicArray * da) {
+    assert(da->buffer != NULL);
+    int size = DynamicArray_size(da);
+    relocate(da, size > 0 ? size : 1, 0);
+}
+
+/* Mathematical operations ***************************************************/
+
+double DynamicArray_sum ( const DynamicArray * da ) {
+    assert(da->buffer != NULL);
+    return DynamicArrayKernel_sum(begin(da), DynamicArray_size(da));
+}
+
+double DynamicArray_mean ( const DynamicArray * da ) {
+    assert(DynamicArray_size(da) > 0);
+    return DynamicArray_sum(da) / DynamicArray_size(da);
+}
+
+double DynamicArray_min ( const DynamicArray * da ) {
+    assert(DynamicArray_size(da) > 0);
+    return DynamicArrayKernel_min(begin(da), DynamicArray_size(da));
+}
+
+double DynamicArray_max ( const DynamicArray * da ) {
+    assert(DynamicArray_size(da) > 0);
+    return DynamicArrayKernel_max(begin(da), DynamicArray_size(da));
+}
+
+double DynamicArray_median ( const DynamicArray * da ) {
+    return DynamicArray_quantile(da, 0.5);
+}
+
+double DynamicArray_quantile ( const DynamicArray * da, double p ) {
+    double result;
+    DynamicArray_quantiles(da, &p, 1, &result);
+    return result;
+}
+
+void DynamicArray_quantiles ( const DynamicArray * da, const double * ps, int n, double * result ) {
+
+    assert(DynamicArray_size(da) > 0);
+
+    int size = DynamicArray_size(da);
+    double * scratch = (double *) malloc(size * sizeof(double));
+    int * order = (int *) malloc(n * sizeof(int));
+    memcpy(scratch, begin(da), size * sizeof(double));
+
+    /* Visit the probabilities in increasing order */
+    for ( int i=0; i<n; i++ ) {
+        assert(0 <= ps[i] && ps[i] <= 1);
+        int j = i;
+        for ( ; j > 0 && ps[order[j-1]] > ps[i]; j-- ) {
+            order[j] = order[j-1];
+        }
+        order[j] = i;
+    }
+
+    /* Everything after scratch[selected] is at least as large as it, so each
+       selection only has to look at what is left of the array */
+    int selected = -1;
+    for ( int i=0; i<n; i++ ) {
+        double h = (size - 1) * ps[order[i]];
+        int k = (int) h;
+        if ( k > selected ) {
+            DynamicArrayKernel_select(scratch + selected + 1, size - selected - 1, k - selected - 1);
+            selected = k;
+        }
+        double lower = scratch[k],
+               upper = h > k ? DynamicArrayKernel_min(scratch + k + 1, size - k - 1) : lower;
+        result[order[i]] = lower + (h - k) * (upper - lower);
+    }
+
+    free(order);
+    free(scratch);
+
+}
+
+/* Bulk operations ***********************************************************/
+
+DynamicArray * DynamicArray_map_op ( const DynamicArray * da, DynamicArrayOp op, double a ) {
+    assert(da->buffer != NULL);
+    int n = DynamicArray_size(da);
+    DynamicArray * result = new_of_size(da->arena, n);
+    DynamicArrayKernel_op(op, a, begin(da), begin(result), n);
+    return result;
+}
+
+void DynamicArray_apply_op ( DynamicArray * da, DynamicArrayOp op, double a ) {
+    assert(da->buffer != NULL);
+    DynamicArrayKernel_op(op, a, begin(da), begin(da), DynamicArray_size(da));
+}
+
+void DynamicArray_axpy ( double a, const DynamicArray * x, DynamicArray * y ) {
+    assert(x->buffer != NULL && y->buffer != NULL);
+    assert(DynamicArray_size(x) == DynamicArray_size(y));
+    DynamicArrayKernel_axpy(a, begin(x), begin(y), DynamicArray_size(x));
+}
+
+double DynamicArray_dot ( const DynamicArray * a, const DynamicArray * b ) {
+    assert(a->buffer != NULL && b->buffer != NULL);
+    assert(DynamicArray_size(a) == DynamicArray_size(b));
+    return DynamicArrayKernel_dot(begin(a), begin(b), DynamicArray_size(a));
+}
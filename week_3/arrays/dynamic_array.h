@@ -1,13 +1,37 @@
 #ifndef _DYNAMIC_ARRAY
 #define _DYNAMIC_ARRAY
 
+#include <stddef.h>
+#include "dynamic_array_kernels.h"
+
 #define DYNAMIC_ARRAY_INITIAL_CAPACITY 10
 
+/* Buffers are aligned to a cache line so that the bulk kernels stream
+   through whole lines */
+#define DYNAMIC_ARRAY_ALIGNMENT 64
+
+/* Default size of the chunks an arena gets from the heap */
+#define DYNAMIC_ARRAY_ARENA_CHUNK_SIZE (1 << 20)
+
+typedef struct DynamicArrayArenaChunk DynamicArrayArenaChunk;
+
+/* A region that array headers and buffers can be allocated from in bulk, so
+   that many short lived arrays can be freed together */
+typedef struct {
+    DynamicArrayArenaChunk * chunks; /* most recent first */
+    size_t chunk_size;
+    int num_arrays;
+} DynamicArrayArena;
+
+typedef struct DynamicArrayMapping DynamicArrayMapping;
+
 typedef struct {
     int capacity,
         origin,
         end;
     double * buffer;
+    DynamicArrayArena * arena;     /* NULL for arrays on the heap */
+    DynamicArrayMapping * mapping; /* NULL unless the buffer is a mapped file */
 } DynamicArray;
 
 /* Constructors / Destructors ************************************************/
@@ -15,6 +39,64 @@ typedef struct {
 DynamicArray * DynamicArray_new(void);
 void DynamicArray_destroy(DynamicArray *);
 
+/*! Return a new array whose header and buffer come from the given arena, or
+ *  from the heap if arena is NULL. Arrays derived from it (by map, map_op,
+ *  subarray, copy and concat) are made in the same arena. The header must not be passed to free.
+ *  \param arena The arena
+ */
+DynamicArray * DynamicArray_new_in(DynamicArrayArena * arena);
+
+/* Memory-mapped arrays ******************************************************/
+
+/* Files made by DynamicArray_open_mapped start with DYNAMIC_ARRAY_FILE_HEADER
+   bytes holding DYNAMIC_ARRAY_FILE_MAGIC and the capacity, origin and end of
+   the array as 64 bit integers, followed by the capacity doubles of the buffer
+   in native byte order. */
+#define DYNAMIC_ARRAY_FILE_HEADER 64
+#define DYNAMIC_ARRAY_FILE_MAGIC "DYNARR01"
+
+/*! Return an array whose buffer is the contents of the file at path, mapped
+ *  into memory, so the array can be larger than RAM and a saved array loads
+ *  without being read or parsed. A missing or empty file is made into an empty
+ *  array. The file grows and shrinks with the buffer and is updated as the
+ *  array changes; call DynamicArray_sync to make sure it is complete on disk.
+ *  DynamicArray_destroy syncs, unmaps and closes the file. Arrays are still
+ *  limited to INT_MAX elements.
+ *  Returns NULL if the file cannot be opened or is not an array file.
+ *  \param path The file
+ */
+DynamicArray * DynamicArray_open_mapped(const char * path);
+
+/*! Write the size of a mapped array to its file and flush it to disk. Does
+ *  nothing for other arrays.
+ *  \param da The array
+ */
+void DynamicArray_sync(DynamicArray * da);
+
+/* Arenas ********************************************************************/
+
+/*! Return a new, empty arena.
+ *  \param chunk_size The number of bytes to get from the heap at a time, or 0
+ *  for DYNAMIC_ARRAY_ARENA_CHUNK_SIZE. Larger buffers get a chunk of their own.
+ */
+DynamicArrayArena * DynamicArrayArena_new(size_t chunk_size);
+
+/*! Destroy every array in the arena at once, without visiting them, keeping
+ *  one chunk of memory for reuse. The arrays must not be used afterwards.
+ *  \param arena The arena
+ */
+void DynamicArrayArena_reset(DynamicArrayArena * arena);
+
+/*! Destroy every array in the arena and free the arena itself.
+ *  \param arena The arena
+ */
+void DynamicArrayArena_destroy(DynamicArrayArena * arena);
+
+/*! Return the number of arrays in the arena that have not been destroyed.
+ *  \param arena The arena
+ */
+int DynamicArrayArena_num_arrays(const DynamicArrayArena * arena);
+
 /* Getters / Setters *********************************************************/
 
 void DynamicArray_set(DynamicArray *, int, double);
@@ -36,6 +118,20 @@ double DynamicArray_pop_front(DynamicArray *);
 
 DynamicArray * DynamicArray_map ( const DynamicArray *, double (*) (double) );
 
+/* Capacity ******************************************************************/
+
+/*! Make sure the array can hold n elements without reallocating, as long as
+ *  elements are only added at the back.
+ *  \param da The array
+ *  \param n The number of elements
+ */
+void DynamicArray_reserve(DynamicArray * da, int n);
+
+/*! Release all unused capacity, at both ends of the array.
+ *  \param da The array
+ */
+void DynamicArray_shrink_to_fit(DynamicArray * da);
+
 /* EXERCISES: ********************************************************/
 
 /*! Return the first value in the given array. Throw a runtime error if the array is empty.
@@ -74,18 +170,68 @@ double DynamicArray_mean ( const DynamicArray * da );
 double DynamicArray_median ( const DynamicArray * da );
 double DynamicArray_sum ( const DynamicArray * da );
 
+/*! Return the p-quantile of the elements, for 0 <= p <= 1, interpolating
+ *  linearly between the two nearest ranks (so p = 0.5 gives the median).
+ *  Runs in linear time on a scratch copy; the array is not modified.
+ *  \param da The array, which must not be empty
+ *  \param p The probability
+ */
+double DynamicArray_quantile ( const DynamicArray * da, double p );
+
+/*! Compute several quantiles at once, sharing one scratch copy and reusing
+ *  the partitioning done for smaller probabilities for the larger ones.
+ *  \param da The array, which must not be empty
+ *  \param ps The n probabilities, in any order
+ *  \param n The number of probabilities
+ *  \param result Where to put the n quantiles, in the order of ps
+ */
+void DynamicArray_quantiles ( const DynamicArray * da, const double * ps, int n, double * result );
+
+/* Bulk operations ***********************************************************/
+
+/*! Return a new array whose elements are op applied to the elements of da. 
+ *  For example, DynamicArray_map_op(da, DYNAMIC_ARRAY_MUL, 2.0) doubles every element.
+ *  Unlike DynamicArray_map, this works on the whole buffer at once with SIMD instructions.
+ *  \param da The array
+ *  \param op The operation
+ *  \param a The scalar argument of op, ignored by unary operations
+ */
+DynamicArray * DynamicArray_map_op ( const DynamicArray * da, DynamicArrayOp op, double a );
+
+/*! Apply op to every element of da in place.
+ *  \param da The array
+ *  \param op The operation
+ *  \param a The scalar argument of op, ignored by unary operations
+ */
+void DynamicArray_apply_op ( DynamicArray * da, DynamicArrayOp op, double a );
+
+/*! Set y to a * x + y, elementwise. The arrays must have the same size.
+ *  \param a The scale factor
+ *  \param x The array to scale
+ *  \param y The array to add to, and the result
+ */
+void DynamicArray_axpy ( double a, const DynamicArray * x, DynamicArray * y );
+
+/*! Return the dot product of two arrays of the same size.
+ *  \param a The first array
+ *  \param b The second array
+ */
+double DynamicArray_dot ( const DynamicArray * a, const DynamicArray * b );
+
 /*! Returns 1 if the array is valid (meaning its buffer is not NULL) and 0 otherwize.
  */
 int DynamicArray_is_valid(const DynamicArray * da);
 
-/*! Returns the number of arrays that have been constructed to far.
+/*! Returns the number of arrays that have been constructed and not yet destroyed,
+ *  counting those in arenas. To destroy many arrays at once, make them in an
+ *  arena and use DynamicArrayArena_reset or DynamicArrayArena_destroy.
  */
 int DynamicArray_num_arrays();
 
-/*! Destroys all arrays that have been constructed so far.
+/*! Return a new array holding a copy of the elements from a up to but not
+ *  including b. Use DynamicArray_slice from dynamic_array_slice.h for a view
+ *  that does not copy.
  */
-int DynamicArray_destroy_all();
-
 DynamicArray * DynamicArray_subarray(DynamicArray *, int, int);
 
 #endif
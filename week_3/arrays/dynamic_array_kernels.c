@@ -0,0 +1,313 @@
+#include <math.h>
+#include "dynamic_array_kernels.h"
+
+/* Vector abstraction: the kernels below are written once against these
+   macros. VEC_WIDTH is left undefined when no vector unit is available,
+   in which case only the scalar loops are compiled. */
+
+#if defined(__AVX__)
+
+#include <immintrin.h>
+typedef __m256d vec;
+#define VEC_WIDTH 4
+#define vec_load(p)      _mm256_loadu_pd(p)
+#define vec_store(p,v)   _mm256_storeu_pd(p,v)
+#define vec_set1(a)      _mm256_set1_pd(a)
+#define vec_add(u,v)     _mm256_add_pd(u,v)
+#define vec_mul(u,v)     _mm256_mul_pd(u,v)
+#define vec_min(u,v)     _mm256_min_pd(u,v)
+#define vec_max(u,v)     _mm256_max_pd(u,v)
+#define vec_sqrt(v)      _mm256_sqrt_pd(v)
+#define vec_andnot(u,v)  _mm256_andnot_pd(u,v)
+#define vec_xor(u,v)     _mm256_xor_pd(u,v)
+
+#elif defined(__SSE2__)
+
+#include <emmintrin.h>
+typedef __m128d vec;
+#define VEC_WIDTH 2
+#define vec_load(p)      _mm_loadu_pd(p)
+#define vec_store(p,v)   _mm_storeu_pd(p,v)
+#define vec_set1(a)      _mm_set1_pd(a)
+#define vec_add(u,v)     _mm_add_pd(u,v)
+#define vec_mul(u,v)     _mm_mul_pd(u,v)
+#define vec_min(u,v)     _mm_min_pd(u,v)
+#define vec_max(u,v)     _mm_max_pd(u,v)
+#define vec_sqrt(v)      _mm_sqrt_pd(v)
+#define vec_andnot(u,v)  _mm_andnot_pd(u,v)
+#define vec_xor(u,v)     _mm_xor_pd(u,v)
+
+#endif
+
+#ifdef VEC_WIDTH
+
+/* Number of vectors processed per iteration of the unrolled reductions.
+   Independent accumulators hide the latency of the add and min/max units. */
+#define UNROLL 4
+#define BLOCK (UNROLL * VEC_WIDTH)
+
+/* Combine the lanes of v with f */
+static double reduce_lanes ( vec v, double (*f) (double, double) ) {
+    double lanes[VEC_WIDTH];
+    vec_store(lanes, v);
+    double result = lanes[0];
+    for ( int i=1; i<VEC_WIDTH; i++ ) {
+        result = f(result, lanes[i]);
+    }
+    return result;
+}
+
+#endif
+
+static double add ( double x, double y ) { return x + y; }
+static double min_of ( double x, double y ) { return x < y ? x : y; }
+static double max_of ( double x, double y ) { return x > y ? x : y; }
+
+double DynamicArrayKernel_sum ( const double * x, int n ) {
+    int i = 0;
+    double result = 0;
+#ifdef VEC_WIDTH
+    vec acc[UNROLL];
+    for ( int k=0; k<UNROLL; k++ ) {
+        acc[k] = vec_set1(0.0);
+    }
+    for ( ; i + BLOCK <= n; i += BLOCK ) {
+        for ( int k=0; k<UNROLL; k++ ) {
+            acc[k] = vec_add(acc[k], vec_load(x + i + k * VEC_WIDTH));
+        }
+    }
+    for ( int k=1; k<UNROLL; k++ ) {
+        acc[0] = vec_add(acc[0], acc[k]);
+    }
+    result = reduce_lanes(acc[0], add);
+#endif
+    for ( ; i<n; i++ ) {
+        result += x[i];
+    }
+    return result;
+}
+
+double DynamicArrayKernel_dot ( const double * x, const double * y, int n ) {
+    int i = 0;
+    double result = 0;
+#ifdef VEC_WIDTH
+    vec acc[UNROLL];
+    for ( int k=0; k<UNROLL; k++ ) {
+        acc[k] = vec_set1(0.0);
+    }
+    for ( ; i + BLOCK <= n; i += BLOCK ) {
+        for ( int k=0; k<UNROLL; k++ ) {
+            int j = i + k * VEC_WIDTH;
+            acc[k] = vec_add(acc[k], vec_mul(vec_load(x + j), vec_load(y + j)));
+        }
+    }
+    for ( int k=1; k<UNROLL; k++ ) {
+        acc[0] = vec_add(acc[0], acc[k]);
+    }
+    result = reduce_lanes(acc[0], add);
+#endif
+    for ( ; i<n; i++ ) {
+        result += x[i] * y[i];
+    }
+    return result;
+}
+
+/* min and max share everything but the combining operation */
+#ifdef VEC_WIDTH
+#define EXTREMUM(vec_op, op)                                                 \
+    int i = 0;                                                               \
+    double result = x[0];                                                    \
+    if ( n >= BLOCK ) {                                                      \
+        vec acc[UNROLL];                                                     \
+        for ( int k=0; k<UNROLL; k++ ) {                                     \
+            acc[k] = vec_load(x + k * VEC_WIDTH);                            \
+        }                                                                    \
+        for ( i = BLOCK; i + BLOCK <= n; i += BLOCK ) {                      \
+            for ( int k=0; k<UNROLL; k++ ) {                                 \
+                acc[k] = vec_op(acc[k], vec_load(x + i + k * VEC_WIDTH));    \
+            }                                                                \
+        }                                                                    \
+        for ( int k=1; k<UNROLL; k++ ) {                                     \
+            acc[0] = vec_op(acc[0], acc[k]);                                 \
+        }                                                                    \
+        result = reduce_lanes(acc[0], op);                                   \
+    }                                                                        \
+    for ( ; i<n; i++ ) {                                                     \
+        result = op(result, x[i]);                                           \
+    }                                                                        \
+    return result;
+#else
+#define EXTREMUM(vec_op, op)                                                 \
+    double result = x[0];                                                    \
+    for ( int i=1; i<n; i++ ) {                                              \
+        result = op(result, x[i]);                                           \
+    }                                                                        \
+    return result;
+#endif
+
+double DynamicArrayKernel_min ( const double * x, int n ) {
+    EXTREMUM(vec_min, min_of)
+}
+
+double DynamicArrayKernel_max ( const double * x, int n ) {
+    EXTREMUM(vec_max, max_of)
+}
+
+void DynamicArrayKernel_axpy ( double a, const double * x, double * y, int n ) {
+    int i = 0;
+#ifdef VEC_WIDTH
+    vec va = vec_set1(a);
+    for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) {
+        vec_store(y + i, vec_add(vec_load(y + i), vec_mul(va, vec_load(x + i))));
+    }
+#endif
+    for ( ; i<n; i++ ) {
+        y[i] += a * x[i];
+    }
+}
+
+static double apply_op ( DynamicArrayOp op, double a, double x ) {
+    switch ( op ) {
+        case DYNAMIC_ARRAY_ADD:    return x + a;
+        case DYNAMIC_ARRAY_MUL:    return x * a;
+        case DYNAMIC_ARRAY_NEG:    return -x;
+        case DYNAMIC_ARRAY_ABS:    return fabs(x);
+        case DYNAMIC_ARRAY_SQUARE: return x * x;
+        case DYNAMIC_ARRAY_SQRT:   return sqrt(x);
+    }
+    return x;
+}
+
+void DynamicArrayKernel_op ( DynamicArrayOp op, double a, const double * x, double * y, int n ) {
+
+    int i = 0;
+
+#ifdef VEC_WIDTH
+    vec va = vec_set1(a),
+        sign = vec_set1(-0.0);
+    /* The switch is outside the loops so that each loop is a straight line */
+    switch ( op ) {
+        case DYNAMIC_ARRAY_ADD:
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) vec_store(y + i, vec_add(vec_load(x + i), va));
+            break;
+        case DYNAMIC_ARRAY_MUL:
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) vec_store(y + i, vec_mul(vec_load(x + i), va));
+            break;
+        case DYNAMIC_ARRAY_NEG:
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) vec_store(y + i, vec_xor(vec_load(x + i), sign));
+            break;
+        case DYNAMIC_ARRAY_ABS:
+            /* clear the sign bit */
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) vec_store(y + i, vec_andnot(sign, vec_load(x + i)));
+            break;
+        case DYNAMIC_ARRAY_SQUARE:
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) {
+                vec v = vec_load(x + i);
+                vec_store(y + i, vec_mul(v, v));
+            }
+            break;
+        case DYNAMIC_ARRAY_SQRT:
+            for ( ; i + VEC_WIDTH <= n; i += VEC_WIDTH ) vec_store(y + i, vec_sqrt(vec_load(x + i)));
+            break;
+    }
+#endif
+
+    for ( ; i<n; i++ ) {
+        y[i] = apply_op(op, a, x[i]);
+    }
+
+}
+
+/* Selection *****************************************************************/
+
+/* Ranges at most this long are finished with an insertion sort */
+#define SELECT_CUTOFF 16
+
+static void swap ( double * x, double * y ) {
+    double temp = *x;
+    *x = *y;
+    *y = temp;
+}
+
+static void insertion_sort ( double * x, int n ) {
+    for ( int i=1; i<n; i++ ) {
+        double v = x[i];
+        int j = i;
+        for ( ; j > 0 && x[j-1] > v; j-- ) {
+            x[j] = x[j-1];
+        }
+        x[j] = v;
+    }
+}
+
+static double median_of_three ( double a, double b, double c ) {
+    if ( a < b ) {
+        return b < c ? b : ( a < c ? c : a );
+    } else {
+        return a < c ? a : ( b < c ? c : b );
+    }
+}
+
+/* A pivot guaranteed to have at least 30% of x on either side: the median of
+   the medians of groups of five. The medians are gathered at the front of x. */
+static double median_of_medians ( double * x, int n ) {
+    int groups = 0;
+    for ( int i=0; i + 5 <= n; i += 5 ) {
+        insertion_sort(x + i, 5);
+        swap(x + groups++, x + i + 2);
+    }
+    if ( groups == 0 ) {
+        insertion_sort(x, n);
+        return x[n/2];
+    }
+    return DynamicArrayKernel_select(x, groups, groups / 2);
+}
+
+/* Three way partition of x around pivot. On return x[0..*lt) < pivot,
+   x[*lt..*gt) == pivot and x[*gt..n) > pivot, so runs of equal values
+   do not degrade the selection. */
+static void partition ( double * x, int n, double pivot, int * lt, int * gt ) {
+    int i = 0, a = 0, b = n;
+    while ( i < b ) {
+        if ( x[i] < pivot ) {
+            swap(x + a++, x + i++);
+        } else if ( x[i] > pivot ) {
+            swap(x + i, x + --b);
+        } else {
+            i++;
+        }
+    }
+    *lt = a;
+    *gt = b;
+}
+
+double DynamicArrayKernel_select ( double * x, int n, int k ) {
+
+    /* Quickselect is allowed about 2 log2(n) rounds before it is assumed to be
+       hitting a bad input and the pivot choice becomes the safe one */
+    int budget = 0;
+    for ( int m = n; m > 1; m >>= 1 ) {
+        budget += 2;
+    }
+
+    while ( n > SELECT_CUTOFF ) {
+        double pivot = budget-- > 0
+          ? median_of_three(x[0], x[n/2], x[n-1])
+          : median_of_medians(x, n);
+        int lt, gt;
+        partition(x, n, pivot, &lt, &gt);
+        if ( k < lt ) {
+            n = lt;
+        } else if ( k >= gt ) {
+            x += gt;
+            n -= gt;
+            k -= gt;
+        } else {
+            return x[k];
+        }
+    }
+
+    insertion_sort(x, n);
+    return x[k];
+
+}
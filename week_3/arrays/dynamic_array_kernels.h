@@ -0,0 +1,38 @@
+#ifndef _DYNAMIC_ARRAY_KERNELS
+#define _DYNAMIC_ARRAY_KERNELS
+
+/*! @file
+ *  Bulk kernels over contiguous spans of doubles, used by the DynamicArray
+ *  bulk operations. They use AVX when the compiler targets it (e.g. with
+ *  -mavx or -march=native), SSE2 otherwise on x86-64, and plain loops
+ *  everywhere else. Pointers need not be aligned.
+ */
+
+/*! Builtin elementwise operations for DynamicArray_map_op and DynamicArray_apply_op */
+typedef enum {
+    DYNAMIC_ARRAY_ADD,    /*!< x + a */
+    DYNAMIC_ARRAY_MUL,    /*!< x * a */
+    DYNAMIC_ARRAY_NEG,    /*!< -x */
+    DYNAMIC_ARRAY_ABS,    /*!< |x| */
+    DYNAMIC_ARRAY_SQUARE, /*!< x * x */
+    DYNAMIC_ARRAY_SQRT    /*!< sqrt(x) */
+} DynamicArrayOp;
+
+double DynamicArrayKernel_sum(const double * x, int n);
+double DynamicArrayKernel_min(const double * x, int n);
+double DynamicArrayKernel_max(const double * x, int n);
+double DynamicArrayKernel_dot(const double * x, const double * y, int n);
+
+/* y[i] = a * x[i] + y[i] */
+void DynamicArrayKernel_axpy(double a, const double * x, double * y, int n);
+
+/* y[i] = op(x[i], a). x and y may be the same span. */
+void DynamicArrayKernel_op(DynamicArrayOp op, double a, const double * x, double * y, int n);
+
+/* Rearranges x so that x[k] is the value it would have if x were sorted, with
+   no larger values before it and no smaller values after it, and returns x[k].
+   Uses introselect: quickselect with a median of three pivot, switching to a
+   median of medians pivot if partitioning goes badly, so it is O(n) worst case. */
+double DynamicArrayKernel_select(double * x, int n, int k);
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "dynamic_array_pipeline.h"
+
+/* private functions *********************************************************/
+
+/* What a terminal operation does with each element leaving the pipeline */
+typedef struct {
+    double (*f) (double, double);
+    double accumulator;
+    int count;
+    DynamicArray * output;
+} Sink;
+
+/* Per-run state of the stages: how far each zip has read into its other
+   array and the running value of each scan */
+typedef struct {
+    int position[DYNAMIC_ARRAY_PIPELINE_MAX_STAGES];
+    double accumulator[DYNAMIC_ARRAY_PIPELINE_MAX_STAGES];
+} State;
+
+static DynamicArrayPipeline * add_stage ( DynamicArrayPipeline * p, DynamicArrayStage stage ) {
+    if ( p->num_stages == DYNAMIC_ARRAY_PIPELINE_MAX_STAGES ) {
+        printf("DynamicArrayPipeline cannot have more than %d stages\n", DYNAMIC_ARRAY_PIPELINE_MAX_STAGES);
+        exit(1);
+    }
+    p->stages[p->num_stages++] = stage;
+    return p;
+}
+
+/* The single pass over the source. Each element goes through every stage
+   before the next one is read, so nothing is stored in between. */
+static void run ( const DynamicArrayPipeline * p, Sink * sink ) {
+
+    State state;
+    for ( int j=0; j<p->num_stages; j++ ) {
+        state.position[j] = 0;
+        state.accumulator[j] = p->stages[j].initial;
+    }
+
+    const double * x = p->source->buffer + p->source->origin;
+    int n = DynamicArray_size(p->source);
+
+    for ( int i=0; i<n; i++ ) {
+
+        double value = x[i];
+        int j = 0;
+
+        for ( ; j < p->num_stages; j++ ) {
+            const DynamicArrayStage * stage = p->stages + j;
+            if ( stage->kind == DYNAMIC_ARRAY_STAGE_MAP ) {
+                value = stage->unary(value);
+            } else if ( stage->kind == DYNAMIC_ARRAY_STAGE_FILTER ) {
+                if ( !stage->predicate(value) ) {
+                    break;
+                }
+            } else if ( stage->kind == DYNAMIC_ARRAY_STAGE_ZIP ) {
+                if ( state.position[j] == DynamicArray_size(stage->other) ) {
+                    return;
+                }
+                value = stage->binary(value, DynamicArray_get(stage->other, state.position[j]++));
+            } else {
+                value = state.accumulator[j] = stage->binary(state.accumulator[j], value);
+            }
+        }
+
+        if ( j == p->num_stages ) {
+            sink->count++;
+            if ( sink->f ) {
+                sink->accumulator = sink->f(sink->accumulator, value);
+            }
+            if ( sink->output ) {
+                DynamicArray_push(sink->output, value);
+            }
+        }
+
+    }
+
+}
+
+static Sink new_sink ( double (*f) (double, double), double initial, DynamicArray * output ) {
+    Sink sink = { f, initial, 0, output };
+    return sink;
+}
+
+static double add ( double x, double y ) {
+    return x + y;
+}
+
+/* public functions **********************************************************/
+
+DynamicArrayPipeline DynamicArray_pipeline ( const DynamicArray * da ) {
+    assert(da->buffer != NULL);
+    DynamicArrayPipeline p;
+    p.source = da;
+    p.num_stages = 0;
+    return p;
+}
+
+DynamicArrayPipeline * DynamicArrayPipeline_map ( DynamicArrayPipeline * p, double (*f) (double) ) {
+    DynamicArrayStage stage = { DYNAMIC_ARRAY_STAGE_MAP, f, NULL, NULL, NULL, 0 };
+    return add_stage(p, stage);
+}
+
+DynamicArrayPipeline * DynamicArrayPipeline_filter ( DynamicArrayPipeline * p, int (*keep) (double) ) {
+    DynamicArrayStage stage = { DYNAMIC_ARRAY_STAGE_FILTER, NULL, keep, NULL, NULL, 0 };
+    return add_stage(p, stage);
+}
+
+DynamicArrayPipeline * DynamicArrayPipeline_zip ( DynamicArrayPipeline * p, const DynamicArray * other,
+                                                  double (*f) (double, double) ) {
+    assert(other->buffer != NULL);
+    DynamicArrayStage stage = { DYNAMIC_ARRAY_STAGE_ZIP, NULL, NULL, f, other, 0 };
+    return add_stage(p, stage);
+}
+
+DynamicArrayPipeline * DynamicArrayPipeline_scan ( DynamicArrayPipeline * p, double (*f) (double, double),
+                                                   double initial ) {
+    DynamicArrayStage stage = { DYNAMIC_ARRAY_STAGE_SCAN, NULL, NULL, f, NULL, initial };
+    return add_stage(p, stage);
+}
+
+double DynamicArrayPipeline_reduce ( const DynamicArrayPipeline * p, double (*f) (double, double), double initial ) {
+    Sink sink = new_sink(f, initial, NULL);
+    run(p, &sink);
+    return sink.accumulator;
+}
+
+double DynamicArrayPipeline_sum ( const DynamicArrayPipeline * p ) {
+    return DynamicArrayPipeline_reduce(p, add, 0);
+}
+
+int DynamicArrayPipeline_count ( const DynamicArrayPipeline * p ) {
+    Sink sink = new_sink(NULL, 0, NULL);
+    run(p, &sink);
+    return sink.count;
+}
+
+DynamicArray * DynamicArrayPipeline_to_array ( const DynamicArrayPipeline * p ) {
+    DynamicArray * result = DynamicArray_new_in(p->source->arena);
+    /* The output is at most as long as the source, so it never has to grow */
+    DynamicArray_reserve(result, DynamicArray_size(p->source));
+    Sink sink = new_sink(NULL, 0, result);
+    run(p, &sink);
+    return result;
+}
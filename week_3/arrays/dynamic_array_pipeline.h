@@ -0,0 +1,86 @@
+#ifndef _DYNAMIC_ARRAY_PIPELINE
+#define _DYNAMIC_ARRAY_PIPELINE
+
+#include "dynamic_array.h"
+
+/*! @file
+ *  Lazy pipelines over a DynamicArray. Stages added with map, filter, zip and
+ *  scan are only recorded; nothing runs until a terminal operation (reduce,
+ *  sum, count or to_array) is called, which pushes each source element through
+ *  all stages in a single pass. No intermediate arrays are made, and only
+ *  to_array allocates. For example
+ *
+ *      DynamicArrayPipeline p = DynamicArray_pipeline(da);
+ *      double s = DynamicArrayPipeline_sum(
+ *                   DynamicArrayPipeline_filter(
+ *                     DynamicArrayPipeline_map(&p, square), is_small));
+ *
+ *  A pipeline is a plain value that can live on the stack. It refers to, but
+ *  does not own, its arrays, and can be run any number of times.
+ */
+
+#define DYNAMIC_ARRAY_PIPELINE_MAX_STAGES 16
+
+typedef enum {
+    DYNAMIC_ARRAY_STAGE_MAP,
+    DYNAMIC_ARRAY_STAGE_FILTER,
+    DYNAMIC_ARRAY_STAGE_ZIP,
+    DYNAMIC_ARRAY_STAGE_SCAN
+} DynamicArrayStageKind;
+
+typedef struct {
+    DynamicArrayStageKind kind;
+    double (*unary) (double);          /* map */
+    int (*predicate) (double);         /* filter */
+    double (*binary) (double, double); /* zip and scan */
+    const DynamicArray * other;        /* zip */
+    double initial;                    /* scan */
+} DynamicArrayStage;
+
+typedef struct {
+    const DynamicArray * source;
+    int num_stages;
+    DynamicArrayStage stages[DYNAMIC_ARRAY_PIPELINE_MAX_STAGES];
+} DynamicArrayPipeline;
+
+/* Constructors **************************************************************/
+
+/*! Return a pipeline with no stages whose elements are those of da.
+ *  \param da The source array
+ */
+DynamicArrayPipeline DynamicArray_pipeline ( const DynamicArray * da );
+
+/* Stages ********************************************************************
+ * Each stage is appended to the pipeline, which is returned for chaining.
+ */
+
+/*! Replace each element x by f(x) */
+DynamicArrayPipeline * DynamicArrayPipeline_map ( DynamicArrayPipeline * p, double (*f) (double) );
+
+/*! Keep only the elements x for which keep(x) is non-zero */
+DynamicArrayPipeline * DynamicArrayPipeline_filter ( DynamicArrayPipeline * p, int (*keep) (double) );
+
+/*! Replace the i-th element x reaching this stage by f(x, y), where y is the
+ *  i-th element of other. The pipeline stops when other runs out. */
+DynamicArrayPipeline * DynamicArrayPipeline_zip ( DynamicArrayPipeline * p, const DynamicArray * other,
+                                                  double (*f) (double, double) );
+
+/*! Replace each element by the running total f(...f(f(initial, x0), x1)..., xi) */
+DynamicArrayPipeline * DynamicArrayPipeline_scan ( DynamicArrayPipeline * p, double (*f) (double, double),
+                                                   double initial );
+
+/* Terminal operations *******************************************************/
+
+/*! Run the pipeline and fold its output with f, starting from initial */
+double DynamicArrayPipeline_reduce ( const DynamicArrayPipeline * p, double (*f) (double, double), double initial );
+
+/*! Run the pipeline and return the sum of its output */
+double DynamicArrayPipeline_sum ( const DynamicArrayPipeline * p );
+
+/*! Run the pipeline and return the number of elements in its output */
+int DynamicArrayPipeline_count ( const DynamicArrayPipeline * p );
+
+/*! Run the pipeline and return its output as a new array, in the source's arena if it has one */
+DynamicArray * DynamicArrayPipeline_to_array ( const DynamicArrayPipeline * p );
+
+#endif
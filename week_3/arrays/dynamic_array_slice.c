@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "dynamic_array_slice.h"
+#include "dynamic_array_writer.h"
+
+/* A piece of a rope and the rope index of its first element */
+typedef struct {
+    DynamicArraySlice slice;
+    int offset;
+} DynamicArrayRopePiece;
+
+/* private functions *********************************************************/
+
+/* Pointer to the first element of the slice. Computed on each use, so that
+   the slice follows the array when its buffer moves. */
+static const double * first ( DynamicArraySlice s ) {
+    return s.array->buffer + s.array->origin + s.start;
+}
+
+/* Copies the elements of the slice to y */
+static void copy_to ( DynamicArraySlice s, double * y ) {
+    const double * x = first(s);
+    if ( s.stride == 1 ) {
+        memcpy(y, x, s.size * sizeof(double));
+    } else {
+        for ( int i=0; i<s.size; i++ ) {
+            y[i] = x[i * s.stride];
+        }
+    }
+}
+
+/* A growing string, filled by the writer behind to_string */
+typedef struct {
+    char * str;
+    int length, capacity;
+} StringBuilder;
+
+static void append ( const char * text, int length, void * context ) {
+    StringBuilder * sb = (StringBuilder *) context;
+    if ( sb->length + length > sb->capacity ) {
+        sb->capacity = 2 * ( sb->length + length );
+        sb->str = (char *) realloc(sb->str, sb->capacity);
+    }
+    memcpy(sb->str + sb->length, text, length);
+    sb->length += length;
+}
+
+static const DynamicArrayRopePiece * piece ( const DynamicArrayRope * rope, int i ) {
+    return (const DynamicArrayRopePiece *) ArbitraryArray_get_ptr(rope->pieces, i);
+}
+
+/* Slices ********************************************************************/
+
+DynamicArraySlice DynamicArray_view ( const DynamicArray * da ) {
+    return DynamicArray_slice(da, 0, DynamicArray_size(da), 1);
+}
+
+DynamicArraySlice DynamicArray_slice ( const DynamicArray * da, int a, int b, int stride ) {
+    assert(da->buffer != NULL);
+    assert(0 <= a && a <= b && b <= DynamicArray_size(da) && stride >= 1);
+    DynamicArraySlice s = { da, a, ( b - a + stride - 1 ) / stride, stride };
+    return s;
+}
+
+DynamicArraySlice DynamicArraySlice_slice ( DynamicArraySlice s, int a, int b, int stride ) {
+    assert(0 <= a && a <= b && b <= s.size && stride >= 1);
+    DynamicArraySlice t = { s.array, s.start + a * s.stride, ( b - a + stride - 1 ) / stride, s.stride * stride };
+    return t;
+}
+
+double DynamicArraySlice_get ( DynamicArraySlice s, int index ) {
+    assert(0 <= index && index < s.size);
+    return first(s)[index * s.stride];
+}
+
+int DynamicArraySlice_size ( DynamicArraySlice s ) {
+    return s.size;
+}
+
+double DynamicArraySlice_sum ( DynamicArraySlice s ) {
+    const double * x = first(s);
+    if ( s.stride == 1 ) {
+        return DynamicArrayKernel_sum(x, s.size);
+    }
+    double result = 0;
+    for ( int i=0; i<s.size; i++ ) {
+        result += x[i * s.stride];
+    }
+    return result;
+}
+
+double DynamicArraySlice_mean ( DynamicArraySlice s ) {
+    assert(s.size > 0);
+    return DynamicArraySlice_sum(s) / s.size;
+}
+
+double DynamicArraySlice_min ( DynamicArraySlice s ) {
+    assert(s.size > 0);
+    const double * x = first(s);
+    if ( s.stride == 1 ) {
+        return DynamicArrayKernel_min(x, s.size);
+    }
+    double result = x[0];
+    for ( int i=1; i<s.size; i++ ) {
+        if ( x[i * s.stride] < result ) {
+            result = x[i * s.stride];
+        }
+    }
+    return result;
+}
+
+double DynamicArraySlice_max ( DynamicArraySlice s ) {
+    assert(s.size > 0);
+    const double * x = first(s);
+    if ( s.stride == 1 ) {
+        return DynamicArrayKernel_max(x, s.size);
+    }
+    double result = x[0];
+    for ( int i=1; i<s.size; i++ ) {
+        if ( x[i * s.stride] > result ) {
+            result = x[i * s.stride];
+        }
+    }
+    return result;
+}
+
+char * DynamicArraySlice_to_string ( DynamicArraySlice s ) {
+    StringBuilder sb = { NULL, 0, 0 };
+    char chunk[4096];
+    DynamicArrayWriter w = DynamicArrayWriter_to_sink(append, &sb, chunk, sizeof(chunk));
+    DynamicArraySlice_write(s, &w);
+    DynamicArrayWriter_finish(&w);
+    append("", 1, &sb); /* NUL */
+    return (char *) realloc(sb.str, sb.length);
+}
+
+DynamicArray * DynamicArraySlice_map ( DynamicArraySlice s, double (*f) (double) ) {
+    DynamicArray * result = DynamicArraySlice_to_array(s);
+    double * y = result->buffer + result->origin;
+    for ( int i=0; i<s.size; i++ ) {
+        y[i] = f(y[i]);
+    }
+    return result;
+}
+
+DynamicArray * DynamicArraySlice_to_array ( DynamicArraySlice s ) {
+    DynamicArray * result = DynamicArray_new_in(s.array->arena);
+    DynamicArray_reserve(result, s.size);
+    copy_to(s, result->buffer + result->origin);
+    result->end = result->origin + s.size;
+    return result;
+}
+
+/* Ropes *********************************************************************/
+
+DynamicArrayRope * DynamicArrayRope_new(void) {
+    DynamicArrayRope * rope = (DynamicArrayRope *) malloc(sizeof(DynamicArrayRope));
+    rope->pieces = ArbitraryArray_new(sizeof(DynamicArrayRopePiece));
+    rope->size = 0;
+    return rope;
+}
+
+void DynamicArrayRope_destroy(DynamicArrayRope * rope) {
+    ArbitraryArray_destroy(rope->pieces);
+    free(rope->pieces);
+    free(rope);
+}
+
+DynamicArrayRope * DynamicArrayRope_append ( DynamicArrayRope * rope, DynamicArraySlice s ) {
+    if ( s.size > 0 ) {
+        DynamicArrayRopePiece p = { s, rope->size };
+        ArbitraryArray_set_from_ptr(rope->pieces, ArbitraryArray_size(rope->pieces), &p);
+        rope->size += s.size;
+    }
+    return rope;
+}
+
+DynamicArrayRope * DynamicArrayRope_concat ( DynamicArrayRope * rope, const DynamicArrayRope * other ) {
+    int n = ArbitraryArray_size(other->pieces);
+    for ( int i=0; i<n; i++ ) {
+        DynamicArrayRope_append(rope, piece(other, i)->slice);
+    }
+    return rope;
+}
+
+int DynamicArrayRope_size ( const DynamicArrayRope * rope ) {
+    return rope->size;
+}
+
+double DynamicArrayRope_get ( const DynamicArrayRope * rope, int index ) {
+    assert(0 <= index && index < rope->size);
+    /* The last piece whose offset is at most index */
+    int lo = 0, hi = ArbitraryArray_size(rope->pieces);
+    while ( hi - lo > 1 ) {
+        int mid = ( lo + hi ) / 2;
+        if ( piece(rope, mid)->offset <= index ) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const DynamicArrayRopePiece * p = piece(rope, lo);
+    return DynamicArraySlice_get(p->slice, index - p->offset);
+}
+
+double DynamicArrayRope_sum ( const DynamicArrayRope * rope ) {
+    double result = 0;
+    int n = ArbitraryArray_size(rope->pieces);
+    for ( int i=0; i<n; i++ ) {
+        result += DynamicArraySlice_sum(piece(rope, i)->slice);
+    }
+    return result;
+}
+
+DynamicArray * DynamicArrayRope_to_array ( const DynamicArrayRope * rope ) {
+    DynamicArray * result = DynamicArray_new();
+    DynamicArray_reserve(result, rope->size);
+    double * y = result->buffer + result->origin;
+    int n = ArbitraryArray_size(rope->pieces);
+    for ( int i=0; i<n; i++ ) {
+        const DynamicArrayRopePiece * p = piece(rope, i);
+        copy_to(p->slice, y + p->offset);
+    }
+    result->end = result->origin + rope->size;
+    return result;
+}
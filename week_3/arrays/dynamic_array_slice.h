@@ -0,0 +1,93 @@
+#ifndef _DYNAMIC_ARRAY_SLICE
+#define _DYNAMIC_ARRAY_SLICE
+
+#include "dynamic_array.h"
+#include "arbitrary_array.h"
+
+/*! @file
+ *  Views of DynamicArrays that do not copy. A DynamicArraySlice refers to
+ *  every stride-th element of a range of an array. It is a small value that
+ *  is passed around by value and never needs to be destroyed. It stays valid
+ *  while the array grows at the back, but not after elements are pushed to or
+ *  popped from the front, or after the array is destroyed.
+ *
+ *  A DynamicArrayRope is a sequence of slices that reads as one array, so
+ *  that concatenation only records the pieces. Copying happens once, if and
+ *  when DynamicArrayRope_to_array is called.
+ */
+
+typedef struct {
+    const DynamicArray * array;
+    int start,  /* index in the array of the first element */
+        size,   /* number of elements */
+        stride; /* distance between consecutive elements in the array */
+} DynamicArraySlice;
+
+typedef struct {
+    ArbitraryArray * pieces; /* of DynamicArrayRopePiece */
+    int size;
+} DynamicArrayRope;
+
+/* Slices ********************************************************************/
+
+/*! Return a slice of the whole array.
+ *  \param da The array
+ */
+DynamicArraySlice DynamicArray_view ( const DynamicArray * da );
+
+/*! Return a slice of the elements of da at a, a + stride, a + 2 stride, ...
+ *  up to but not including b.
+ *  \param da The array
+ *  \param a The first index, at least 0
+ *  \param b The index to stop before, at most the size of the array
+ *  \param stride The step, at least 1
+ */
+DynamicArraySlice DynamicArray_slice ( const DynamicArray * da, int a, int b, int stride );
+
+/*! Return a slice of a slice, with indices relative to s. */
+DynamicArraySlice DynamicArraySlice_slice ( DynamicArraySlice s, int a, int b, int stride );
+
+double DynamicArraySlice_get ( DynamicArraySlice s, int index );
+int DynamicArraySlice_size ( DynamicArraySlice s );
+
+/*! Read-only operations, as for DynamicArray. min, max and mean require a
+ *  non-empty slice. Contiguous slices use the SIMD kernels.
+ */
+double DynamicArraySlice_sum ( DynamicArraySlice s );
+double DynamicArraySlice_mean ( DynamicArraySlice s );
+double DynamicArraySlice_min ( DynamicArraySlice s );
+double DynamicArraySlice_max ( DynamicArraySlice s );
+char * DynamicArraySlice_to_string ( DynamicArraySlice s );
+
+/*! Return a new array of f applied to each element of the slice */
+DynamicArray * DynamicArraySlice_map ( DynamicArraySlice s, double (*f) (double) );
+
+/*! Return a new array holding a copy of the elements of the slice */
+DynamicArray * DynamicArraySlice_to_array ( DynamicArraySlice s );
+
+/* Ropes *********************************************************************/
+
+DynamicArrayRope * DynamicArrayRope_new(void);
+
+/*! Free the rope. The arrays it refers to are not affected. */
+void DynamicArrayRope_destroy(DynamicArrayRope * rope);
+
+/*! Add the slice at the end of the rope, without copying its elements.
+ *  Returns the rope, for chaining.
+ */
+DynamicArrayRope * DynamicArrayRope_append ( DynamicArrayRope * rope, DynamicArraySlice s );
+
+/*! Add all the pieces of other at the end of the rope. */
+DynamicArrayRope * DynamicArrayRope_concat ( DynamicArrayRope * rope, const DynamicArrayRope * other );
+
+int DynamicArrayRope_size ( const DynamicArrayRope * rope );
+
+/*! Return the element at index, finding its piece by binary search */
+double DynamicArrayRope_get ( const DynamicArrayRope * rope, int index );
+
+double DynamicArrayRope_sum ( const DynamicArrayRope * rope );
+
+/*! Return a new array holding the elements of the rope, allocated once */
+DynamicArray * DynamicArrayRope_to_array ( const DynamicArrayRope * rope );
+
+#endif
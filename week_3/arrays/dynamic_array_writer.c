@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <assert.h>
+
+#include "dynamic_array_writer.h"
+
+/* Grisu2 ********************************************************************
+ *
+ * Shortest decimal representation of a double, adapted from the reference
+ * implementation by Florian Loitsch (MIT license), "Printing Floating-Point
+ * Numbers Quickly and Accurately with Integers", PLDI 2010, by way of the
+ * version in nlohmann/json. Grisu2 always produces digits that read back as
+ * the same double, and the shortest such digits for about 99.9% of inputs.
+ */
+
+/* f * 2^e */
+typedef struct {
+    uint64_t f;
+    int e;
+} DiyFp;
+
+/* A cached power of ten c = f * 2^e ~= 10^k */
+typedef struct {
+    uint64_t f;
+    int e, k;
+} CachedPower;
+
+/* The exponent range the products w * c are brought into */
+#define ALPHA -60
+#define GAMMA -32
+
+static const CachedPower cached_powers[] = {
+    { 0xAB70FE17C79AC6CAULL, -1060, -300 }, { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+    { 0xBE5691EF416BD60CULL, -1007, -284 }, { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+    { 0xD3515C2831559A83ULL,  -954, -268 }, { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+    { 0xEA9C227723EE8BCBULL,  -901, -252 }, { 0xAECC49914078536DULL,  -874, -244 },
+    { 0x823C12795DB6CE57ULL,  -847, -236 }, { 0xC21094364DFB5637ULL,  -821, -228 },
+    { 0x9096EA6F3848984FULL,  -794, -220 }, { 0xD77485CB25823AC7ULL,  -768, -212 },
+    { 0xA086CFCD97BF97F4ULL,  -741, -204 }, { 0xEF340A98172AACE5ULL,  -715, -196 },
+    { 0xB23867FB2A35B28EULL,  -688, -188 }, { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+    { 0xC5DD44271AD3CDBAULL,  -635, -172 }, { 0x936B9FCEBB25C996ULL,  -608, -164 },
+    { 0xDBAC6C247D62A584ULL,  -582, -156 }, { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+    { 0xF3E2F893DEC3F126ULL,  -529, -140 }, { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+    { 0x87625F056C7C4A8BULL,  -475, -124 }, { 0xC9BCFF6034C13053ULL,  -449, -116 },
+    { 0x964E858C91BA2655ULL,  -422, -108 }, { 0xDFF9772470297EBDULL,  -396, -100 },
+    { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 }, { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+    { 0xB94470938FA89BCFULL,  -316,  -76 }, { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+    { 0xCDB02555653131B6ULL,  -263,  -60 }, { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+    { 0xE45C10C42A2B3B06ULL,  -210,  -44 }, { 0xAA242499697392D3ULL,  -183,  -36 },
+    { 0xFD87B5F28300CA0EULL,  -157,  -28 }, { 0xBCE5086492111AEBULL,  -130,  -20 },
+    { 0x8CBCCC096F5088CCULL,  -103,  -12 }, { 0xD1B71758E219652CULL,   -77,   -4 },
+    { 0x9C40000000000000ULL,   -50,    4 }, { 0xE8D4A51000000000ULL,   -24,   12 },
+    { 0xAD78EBC5AC620000ULL,     3,   20 }, { 0x813F3978F8940984ULL,    30,   28 },
+    { 0xC097CE7BC90715B3ULL,    56,   36 }, { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+    { 0xD5D238A4ABE98068ULL,   109,   52 }, { 0x9F4F2726179A2245ULL,   136,   60 },
+    { 0xED63A231D4C4FB27ULL,   162,   68 }, { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+    { 0x83C7088E1AAB65DBULL,   216,   84 }, { 0xC45D1DF942711D9AULL,   242,   92 },
+    { 0x924D692CA61BE758ULL,   269,  100 }, { 0xDA01EE641A708DEAULL,   295,  108 },
+    { 0xA26DA3999AEF774AULL,   322,  116 }, { 0xF209787BB47D6B85ULL,   348,  124 },
+    { 0xB454E4A179DD1877ULL,   375,  132 }, { 0x865B86925B9BC5C2ULL,   402,  140 },
+    { 0xC83553C5C8965D3DULL,   428,  148 }, { 0x952AB45CFA97A0B3ULL,   455,  156 },
+    { 0xDE469FBD99A05FE3ULL,   481,  164 }, { 0xA59BC234DB398C25ULL,   508,  172 },
+    { 0xF6C69A72A3989F5CULL,   534,  180 }, { 0xB7DCBF5354E9BECEULL,   561,  188 },
+    { 0x88FCF317F22241E2ULL,   588,  196 }, { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+    { 0x98165AF37B2153DFULL,   641,  212 }, { 0xE2A0B5DC971F303AULL,   667,  220 },
+    { 0xA8D9D1535CE3B396ULL,   694,  228 }, { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+    { 0xBB764C4CA7A44410ULL,   747,  244 }, { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+    { 0xD01FEF10A657842CULL,   800,  260 }, { 0x9B10A4E5E9913129ULL,   827,  268 },
+    { 0xE7109BFBA19C0C9DULL,   853,  276 }, { 0xAC2820D9623BF429ULL,   880,  284 },
+    { 0x80444B5E7AA7CF85ULL,   907,  292 }, { 0xBF21E44003ACDD2DULL,   933,  300 },
+    { 0x8E679C2F5E44FF8FULL,   960,  308 }, { 0xD433179D9C8CB841ULL,   986,  316 },
+    { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+};
+
+static DiyFp diyfp ( uint64_t f, int e ) {
+    DiyFp x = { f, e };
+    return x;
+}
+
+/* x * y, keeping the upper 64 bits of the product, rounded */
+static DiyFp multiply ( DiyFp x, DiyFp y ) {
+    uint64_t u_lo = x.f & 0xFFFFFFFFu, u_hi = x.f >> 32,
+             v_lo = y.f & 0xFFFFFFFFu, v_hi = y.f >> 32,
+             p0 = u_lo * v_lo, p1 = u_lo * v_hi,
+             p2 = u_hi * v_lo, p3 = u_hi * v_hi,
+             q = ( p0 >> 32 ) + ( p1 & 0xFFFFFFFFu ) + ( p2 & 0xFFFFFFFFu ) + ( 1ULL << 31 );
+    return diyfp(p3 + ( p1 >> 32 ) + ( p2 >> 32 ) + ( q >> 32 ), x.e + y.e + 64);
+}
+
+static DiyFp normalize ( DiyFp x ) {
+    while ( ( x.f >> 63 ) == 0 ) {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+/* The positive finite value v and the boundaries m_minus and m_plus halfway
+   to its neighbours, all with the exponent of the normalized m_plus */
+static void boundaries ( double value, DiyFp * v, DiyFp * m_minus, DiyFp * m_plus ) {
+
+    const int precision = 53,
+              bias = 1023 + precision - 1,
+              min_exp = 1 - bias;
+    const uint64_t hidden_bit = 1ULL << ( precision - 1 );
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t E = bits >> ( precision - 1 ),
+             F = bits & ( hidden_bit - 1 );
+
+    DiyFp w = E == 0 ? diyfp(F, min_exp) : diyfp(F + hidden_bit, (int) E - bias);
+
+    /* For powers of two the lower neighbour is closer */
+    DiyFp plus = normalize(diyfp(2 * w.f + 1, w.e - 1)),
+          minus = F == 0 && E > 1 ? diyfp(4 * w.f - 1, w.e - 2) : diyfp(2 * w.f - 1, w.e - 1);
+
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    *v = normalize(w);
+    *m_minus = minus;
+    *m_plus = plus;
+
+}
+
+/* A cached power c such that ALPHA <= e_c + e + 64 <= GAMMA */
+static CachedPower cached_power ( int e ) {
+    int f = ALPHA - e - 1,
+        k = ( f * 78913 ) / ( 1 << 18 ) + ( f > 0 ),
+        index = ( 300 + k + 7 ) / 8;
+    return cached_powers[index];
+}
+
+/* The number of decimal digits of n, with pow10 set to 10^(digits - 1) */
+static int largest_pow10 ( uint32_t n, uint32_t * pow10 ) {
+    int k = 1;
+    *pow10 = 1;
+    while ( k < 10 && n / *pow10 >= 10 ) {
+        *pow10 *= 10;
+        k++;
+    }
+    return k;
+}
+
+/* Nudges the last digit down while that brings the result closer to w */
+static void round_weed ( char * buf, int len, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k ) {
+    while ( rest < dist && delta - rest >= ten_k &&
+            ( rest + ten_k < dist || dist - rest > rest + ten_k - dist ) ) {
+        buf[len - 1]--;
+        rest += ten_k;
+    }
+}
+
+/* Generates digits of a value between M_minus and M_plus, as close to w as
+   possible, returning their number and adding to *exponent */
+static int digit_gen ( char * buffer, int * exponent, DiyFp M_minus, DiyFp w, DiyFp M_plus ) {
+
+    uint64_t delta = M_plus.f - M_minus.f,
+             dist = M_plus.f - w.f;
+    DiyFp one = diyfp(1ULL << -M_plus.e, M_plus.e);
+
+    uint32_t p1 = (uint32_t) ( M_plus.f >> -one.e ), pow10;
+    uint64_t p2 = M_plus.f & ( one.f - 1 );
+    int length = 0;
+
+    /* Integral part */
+    for ( int n = largest_pow10(p1, &pow10); n > 0; ) {
+        buffer[length++] = (char) ( '0' + p1 / pow10 );
+        p1 %= pow10;
+        n--;
+        uint64_t rest = ( (uint64_t) p1 << -one.e ) + p2;
+        if ( rest <= delta ) {
+            *exponent += n;
+            round_weed(buffer, length, dist, delta, rest, (uint64_t) pow10 << -one.e);
+            return length;
+        }
+        pow10 /= 10;
+    }
+
+    /* Fractional part */
+    int m = 0;
+    do {
+        p2 *= 10;
+        buffer[length++] = (char) ( '0' + ( p2 >> -one.e ) );
+        p2 &= one.f - 1;
+        m++;
+        delta *= 10;
+        dist *= 10;
+    } while ( p2 > delta );
+
+    *exponent -= m;
+    round_weed(buffer, length, dist, delta, p2, one.f);
+    return length;
+
+}
+
+/* Shortest digits of the positive finite value, which is digits * 10^exponent */
+static int grisu2 ( double value, char * digits, int * exponent ) {
+    DiyFp v, m_minus, m_plus;
+    boundaries(value, &v, &m_minus, &m_plus);
+    CachedPower cached = cached_power(m_plus.e);
+    DiyFp c = diyfp(cached.f, cached.e),
+          w = multiply(v, c),
+          w_minus = multiply(m_minus, c),
+          w_plus = multiply(m_plus, c);
+    *exponent = -cached.k;
+    return digit_gen(digits, exponent,
+                     diyfp(w_minus.f + 1, w_minus.e), w, diyfp(w_plus.f - 1, w_plus.e));
+}
+
+/* Writes e as e.g. e+21 or e-07 and returns the number of characters */
+static int format_exponent ( char * out, int e ) {
+    int n = 0;
+    out[n++] = 'e';
+    out[n++] = e < 0 ? '-' : '+';
+    e = e < 0 ? -e : e;
+    if ( e >= 100 ) {
+        out[n++] = (char) ( '0' + e / 100 );
+        e %= 100;
+        out[n++] = (char) ( '0' + e / 10 );
+    } else {
+        out[n++] = (char) ( '0' + e / 10 );
+    }
+    out[n++] = (char) ( '0' + e % 10 );
+    return n;
+}
+
+int DynamicArray_format_double ( double x, char * out ) {
+
+    int n = 0;
+
+    if ( x != x ) {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+    if ( signbit(x) ) {
+        out[n++] = '-';
+        x = -x;
+    }
+    if ( x == 0 ) {
+        out[n++] = '0';
+        return n;
+    }
+    if ( isinf(x) ) {
+        memcpy(out + n, "inf", 3);
+        return n + 3;
+    }
+
+    char * buf = out + n;
+    int exponent,
+        k = grisu2(x, buf, &exponent), /* digits */
+        point = k + exponent;           /* position of the decimal point */
+
+    if ( k <= point && point <= 15 ) {
+        /* integral: 1234500 */
+        memset(buf + k, '0', point - k);
+        return n + point;
+    } else if ( 0 < point && point <= 15 ) {
+        /* 1234.5 */
+        memmove(buf + point + 1, buf + point, k - point);
+        buf[point] = '.';
+        return n + k + 1;
+    } else if ( -4 < point && point <= 0 ) {
+        /* 0.0012345 */
+        memmove(buf + 2 - point, buf, k);
+        buf[0] = '0';
+        buf[1] = '.';
+        memset(buf + 2, '0', -point);
+        return n + 2 - point + k;
+    } else if ( k == 1 ) {
+        /* 1e+30 */
+        return n + 1 + format_exponent(buf + 1, point - 1);
+    } else {
+        /* 1.2345e+30 */
+        memmove(buf + 2, buf + 1, k - 1);
+        buf[1] = '.';
+        return n + k + 1 + format_exponent(buf + k + 1, point - 1);
+    }
+
+}
+
+/* Writer ********************************************************************/
+
+static DynamicArrayWriter new_writer ( char * buffer, int capacity, FILE * file,
+                                       void (*sink) (const char *, int, void *), void * context ) {
+    DynamicArrayWriter w = { buffer, capacity, 0, file, sink, context, 0, 0 };
+    return w;
+}
+
+/* Non-zero if full chunks are passed on rather than dropped */
+static int streaming ( const DynamicArrayWriter * w ) {
+    return w->file != NULL || w->sink != NULL;
+}
+
+/* Passes on the chunk and empties it */
+static void flush ( DynamicArrayWriter * w ) {
+    if ( w->used == 0 ) {
+        return;
+    }
+    if ( w->file ) {
+        fwrite(w->buffer, 1, w->used, w->file);
+    } else {
+        w->sink(w->buffer, w->used, w->context);
+    }
+    w->used = 0;
+}
+
+/* Room left in a memory buffer, keeping a byte for the NUL */
+static int room ( const DynamicArrayWriter * w ) {
+    return streaming(w) ? w->capacity - w->used : w->capacity - 1 - w->used;
+}
+
+DynamicArrayWriter DynamicArrayWriter_to_buffer ( char * buffer, int capacity ) {
+    assert(capacity >= 1);
+    return new_writer(buffer, capacity, NULL, NULL, NULL);
+}
+
+DynamicArrayWriter DynamicArrayWriter_to_file ( FILE * file, char * chunk, int chunk_size ) {
+    assert(file != NULL && chunk_size >= DYNAMIC_ARRAY_DOUBLE_CHARS);
+    return new_writer(chunk, chunk_size, file, NULL, NULL);
+}
+
+DynamicArrayWriter DynamicArrayWriter_to_sink ( void (*sink) (const char *, int, void *), void * context,
+                                                char * chunk, int chunk_size ) {
+    assert(sink != NULL && chunk_size >= DYNAMIC_ARRAY_DOUBLE_CHARS);
+    return new_writer(chunk, chunk_size, NULL, sink, context);
+}
+
+void DynamicArrayWriter_write ( DynamicArrayWriter * w, const char * text, int length ) {
+    w->written += length;
+    while ( length > 0 ) {
+        if ( room(w) == 0 ) {
+            if ( !streaming(w) ) {
+                w->overflow = 1;
+                return;
+            }
+            flush(w);
+        }
+        int n = length < room(w) ? length : room(w);
+        memcpy(w->buffer + w->used, text, n);
+        w->used += n;
+        text += n;
+        length -= n;
+    }
+}
+
+void DynamicArrayWriter_double ( DynamicArrayWriter * w, double x ) {
+    if ( room(w) < DYNAMIC_ARRAY_DOUBLE_CHARS && streaming(w) ) {
+        flush(w);
+    }
+    if ( room(w) >= DYNAMIC_ARRAY_DOUBLE_CHARS ) {
+        /* The common case: format in place, without a copy */
+        int n = DynamicArray_format_double(x, w->buffer + w->used);
+        w->used += n;
+        w->written += n;
+    } else {
+        char temp[DYNAMIC_ARRAY_DOUBLE_CHARS];
+        DynamicArrayWriter_write(w, temp, DynamicArray_format_double(x, temp));
+    }
+}
+
+long DynamicArrayWriter_finish ( DynamicArrayWriter * w ) {
+    if ( streaming(w) ) {
+        flush(w);
+        if ( w->file ) {
+            fflush(w->file);
+        }
+    } else {
+        w->buffer[w->used] = '\0';
+    }
+    return w->written;
+}
+
+void DynamicArraySlice_write ( DynamicArraySlice s, DynamicArrayWriter * w ) {
+    const double * x = s.array->buffer + s.array->origin + s.start;
+    DynamicArrayWriter_write(w, "[", 1);
+    for ( int i=0; i<s.size; i++ ) {
+        if ( i > 0 ) {
+            if ( room(w) > 0 ) {
+                w->buffer[w->used++] = ',';
+                w->written++;
+            } else {
+                DynamicArrayWriter_write(w, ",", 1);
+            }
+        }
+        DynamicArrayWriter_double(w, x[i * s.stride]);
+    }
+    DynamicArrayWriter_write(w, "]", 1);
+}
+
+void DynamicArray_write ( const DynamicArray * da, DynamicArrayWriter * w ) {
+    assert(da->buffer != NULL);
+    DynamicArraySlice_write(DynamicArray_view(da), w);
+}
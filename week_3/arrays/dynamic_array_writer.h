@@ -0,0 +1,79 @@
+#ifndef _DYNAMIC_ARRAY_WRITER
+#define _DYNAMIC_ARRAY_WRITER
+
+#include <stdio.h>
+#include "dynamic_array.h"
+#include "dynamic_array_slice.h"
+
+/*! @file
+ *  Streaming text output for arrays. A DynamicArrayWriter fills a buffer
+ *  supplied by the caller. Depending on how it was made, a full buffer is
+ *  either written to a FILE*, passed to a callback as a chunk, or (for a plain
+ *  memory buffer) the rest of the output is counted but dropped, like snprintf.
+ *  Memory use is bounded by the buffer no matter how large the array is.
+ *
+ *  Doubles are printed with the fewest digits that read back as the same
+ *  double, using Florian Loitsch's Grisu2 algorithm, so that output can be
+ *  used as JSON without losing precision.
+ */
+
+/* Enough room for any double printed by DynamicArray_format_double */
+#define DYNAMIC_ARRAY_DOUBLE_CHARS 32
+
+typedef struct {
+    char * buffer;     /* the chunk being filled */
+    int capacity,
+        used;
+    FILE * file;       /* where full chunks go, if not NULL */
+    void (*sink) (const char * chunk, int length, void * context);
+    void * context;    /* passed to sink */
+    long written;      /* bytes produced so far, including any that were dropped */
+    int overflow;      /* non-zero if a memory buffer was too small */
+} DynamicArrayWriter;
+
+/* Constructors **************************************************************/
+
+/*! Return a writer into a fixed memory buffer. DynamicArrayWriter_finish adds
+ *  a terminating NUL, for which one byte of capacity is kept.
+ *  \param buffer The buffer
+ *  \param capacity Its size in bytes, at least 1
+ */
+DynamicArrayWriter DynamicArrayWriter_to_buffer ( char * buffer, int capacity );
+
+/*! Return a writer that sends its output to a file in chunks of chunk_size bytes.
+ *  \param file The file
+ *  \param chunk A buffer of chunk_size bytes for the writer to use
+ *  \param chunk_size The size of the buffer, at least DYNAMIC_ARRAY_DOUBLE_CHARS
+ */
+DynamicArrayWriter DynamicArrayWriter_to_file ( FILE * file, char * chunk, int chunk_size );
+
+/*! Return a writer that calls sink(chunk, length, context) for each chunk of
+ *  output, e.g. to send an array over a socket as it is printed.
+ */
+DynamicArrayWriter DynamicArrayWriter_to_sink ( void (*sink) (const char *, int, void *), void * context,
+                                                char * chunk, int chunk_size );
+
+/* Output ********************************************************************/
+
+void DynamicArrayWriter_write ( DynamicArrayWriter * w, const char * text, int length );
+void DynamicArrayWriter_double ( DynamicArrayWriter * w, double x );
+
+/*! Pass on any buffered output, or NUL terminate a memory buffer. Returns the
+ *  total number of bytes produced, not counting the NUL.
+ */
+long DynamicArrayWriter_finish ( DynamicArrayWriter * w );
+
+/*! Print the array as [x0,x1,...] */
+void DynamicArray_write ( const DynamicArray * da, DynamicArrayWriter * w );
+void DynamicArraySlice_write ( DynamicArraySlice s, DynamicArrayWriter * w );
+
+/*! Print x into out with the fewest digits that read back as x, in fixed
+ *  notation for moderate exponents and as e.g. 1.5e+300 otherwise. Integral
+ *  values have no decimal point. Returns the number of characters, without
+ *  writing a NUL.
+ *  \param x The value
+ *  \param out At least DYNAMIC_ARRAY_DOUBLE_CHARS bytes
+ */
+int DynamicArray_format_double ( double x, char * out );
+
+#endif
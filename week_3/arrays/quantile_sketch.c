@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "quantile_sketch.h"
+
+#define M QUANTILE_SKETCH_MARKERS
+
+/* private functions *********************************************************/
+
+/* Piecewise parabolic prediction of the height of marker i moved by d = +-1 */
+static double parabolic ( const QuantileSketch * s, int i, int d ) {
+    const double * q = s->heights;
+    const int * n = s->positions;
+    return q[i] + (double) d / ( n[i+1] - n[i-1] ) * (
+        ( n[i] - n[i-1] + d ) * ( q[i+1] - q[i] ) / ( n[i+1] - n[i] ) +
+        ( n[i+1] - n[i] - d ) * ( q[i] - q[i-1] ) / ( n[i] - n[i-1] ) );
+}
+
+/* Linear prediction, used when the parabolic one would break monotonicity */
+static double linear ( const QuantileSketch * s, int i, int d ) {
+    const double * q = s->heights;
+    const int * n = s->positions;
+    return q[i] + d * ( q[i+d] - q[i] ) / ( n[i+d] - n[i] );
+}
+
+/* public functions **********************************************************/
+
+QuantileSketch * QuantileSketch_new(double p) {
+    assert(0 < p && p < 1);
+    QuantileSketch * s = (QuantileSketch *) malloc(sizeof(QuantileSketch));
+    s->p = p;
+    s->count = 0;
+    double increments[M] = { 0, p/2, p, (1+p)/2, 1 };
+    for ( int i=0; i<M; i++ ) {
+        s->positions[i] = i;
+        s->desired[i] = 4 * increments[i];
+        s->increments[i] = increments[i];
+    }
+    return s;
+}
+
+void QuantileSketch_destroy(QuantileSketch * s) {
+    free(s);
+}
+
+void QuantileSketch_add(QuantileSketch * s, double x) {
+
+    double * q = s->heights;
+    int * n = s->positions;
+
+    /* The first five values are kept sorted as the initial marker heights */
+    if ( s->count < M ) {
+        int j = s->count++;
+        for ( ; j > 0 && q[j-1] > x; j-- ) {
+            q[j] = q[j-1];
+        }
+        q[j] = x;
+        return;
+    }
+    s->count++;
+
+    /* Find the cell x falls in, extending the extreme markers if needed */
+    int k;
+    if ( x < q[0] ) {
+        q[0] = x;
+        k = 0;
+    } else if ( x >= q[M-1] ) {
+        q[M-1] = x;
+        k = M - 2;
+    } else {
+        for ( k = 0; x >= q[k+1]; k++ );
+    }
+
+    for ( int i=k+1; i<M; i++ ) {
+        n[i]++;
+    }
+    for ( int i=0; i<M; i++ ) {
+        s->desired[i] += s->increments[i];
+    }
+
+    /* Move the middle markers one step toward their desired positions */
+    for ( int i=1; i<M-1; i++ ) {
+        double delta = s->desired[i] - n[i];
+        if ( ( delta >= 1 && n[i+1] - n[i] > 1 ) || ( delta <= -1 && n[i-1] - n[i] < -1 ) ) {
+            int d = delta > 0 ? 1 : -1;
+            double h = parabolic(s, i, d);
+            q[i] = q[i-1] < h && h < q[i+1] ? h : linear(s, i, d);
+            n[i] += d;
+        }
+    }
+
+}
+
+void QuantileSketch_add_array(QuantileSketch * s, const DynamicArray * da) {
+    for ( int i=0; i<DynamicArray_size(da); i++ ) {
+        QuantileSketch_add(s, da->buffer[da->origin + i]);
+    }
+}
+
+void QuantileSketch_push(QuantileSketch * s, DynamicArray * da, double x) {
+    DynamicArray_push(da, x);
+    QuantileSketch_add(s, x);
+}
+
+double QuantileSketch_get(const QuantileSketch * s) {
+    assert(s->count > 0);
+    if ( s->count <= M ) {
+        /* Exact, interpolating between ranks as DynamicArray_quantile does */
+        double h = ( s->count - 1 ) * s->p;
+        int k = (int) h;
+        if ( k + 1 < s->count ) {
+            return s->heights[k] + ( h - k ) * ( s->heights[k+1] - s->heights[k] );
+        }
+        return s->heights[k];
+    }
+    return s->heights[2];
+}
+
+int QuantileSketch_count(const QuantileSketch * s) {
+    return s->count;
+}
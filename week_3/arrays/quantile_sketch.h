@@ -0,0 +1,58 @@
+#ifndef _QUANTILE_SKETCH
+#define _QUANTILE_SKETCH
+
+#include "dynamic_array.h"
+
+/*! @file
+ *  Streaming estimate of a quantile using the P-square algorithm of Jain and
+ *  Chlamtac (1985). The sketch keeps five markers whose heights approximate
+ *  the minimum, the p/2, p and (1+p)/2 quantiles and the maximum, so it uses
+ *  constant memory and O(1) time per value no matter how many values are
+ *  added. Track p50, p95 and p99 with three sketches.
+ */
+
+#define QUANTILE_SKETCH_MARKERS 5
+
+typedef struct {
+    double p,
+           heights[QUANTILE_SKETCH_MARKERS],  /* marker heights, i.e. value estimates */
+           desired[QUANTILE_SKETCH_MARKERS],  /* desired marker positions */
+           increments[QUANTILE_SKETCH_MARKERS];
+    int positions[QUANTILE_SKETCH_MARKERS],   /* actual marker positions */
+        count;
+} QuantileSketch;
+
+/* Constructors / Destructors ************************************************/
+
+/*! Return a new sketch estimating the p-quantile, for 0 < p < 1.
+ */
+QuantileSketch * QuantileSketch_new(double p);
+void QuantileSketch_destroy(QuantileSketch *);
+
+/* Operations ****************************************************************/
+
+/*! Add a value to the stream.
+ */
+void QuantileSketch_add(QuantileSketch *, double);
+
+/*! Add every element of the array to the stream, in order.
+ */
+void QuantileSketch_add_array(QuantileSketch *, const DynamicArray *);
+
+/*! Push value onto the array and add it to the sketch, so that the sketch
+ *  follows the array as it is built.
+ */
+void QuantileSketch_push(QuantileSketch *, DynamicArray *, double);
+
+/* Getters *******************************************************************/
+
+/*! Return the current estimate of the quantile. With five or fewer values
+ *  added the result is exact. The sketch must not be empty.
+ */
+double QuantileSketch_get(const QuantileSketch *);
+
+/*! Return the number of values added so far.
+ */
+int QuantileSketch_count(const QuantileSketch *);
+
+#endif
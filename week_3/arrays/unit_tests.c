@@ -1,7 +1,14 @@
 #include <math.h>
 #include <float.h> /* defines DBL_EPSILON */
+#include <unistd.h>
+#include <sys/stat.h>
 #include "dynamic_array.h"
 #include "arbitrary_array.h"
+#include "arbitrary_array_typed.h"
+#include "quantile_sketch.h"
+#include "dynamic_array_pipeline.h"
+#include "dynamic_array_slice.h"
+#include "dynamic_array_writer.h"
 #include "gtest/gtest.h"
 
 #define X 1.2345
@@ -10,6 +17,8 @@ typedef struct {
     double x, y, z;
 } Point;
 
+ARBITRARY_ARRAY_DEFINE(PointArray, Point)
+
 char * point_to_string ( void * p ) {
     Point * q = (Point *) p;
     char * str = (char *) calloc(40, sizeof(char));
@@ -23,6 +32,394 @@ namespace {
         DynamicArray * a = DynamicArray_new();
     }
 
+    TEST(DynamicArray, Growth) {
+        DynamicArray * da = DynamicArray_new();
+        DynamicArray_set(da, 400, X);
+        DynamicArray_set(da, 200, X/2);
+        ASSERT_EQ(401, DynamicArray_size(da));
+        ASSERT_EQ(X/2, DynamicArray_get(da, 200));
+        ASSERT_EQ(X, DynamicArray_get(da, 400));
+        for ( int i=0; i<400; i++ ) {
+            if ( i != 200 ) {
+                ASSERT_EQ(0, DynamicArray_get(da, i));
+            }
+        }
+        for ( int i=0; i<1000; i++ ) {
+            DynamicArray_push_front(da, -i);
+        }
+        ASSERT_EQ(1401, DynamicArray_size(da));
+        ASSERT_EQ(-999, DynamicArray_get(da, 0));
+        ASSERT_EQ(X, DynamicArray_get(da, 1400));
+        ASSERT_EQ(X, DynamicArray_pop(da));
+        ASSERT_EQ(-999, DynamicArray_pop_front(da));
+        DynamicArray_destroy(da);
+    }
+
+    TEST(DynamicArray, ReserveAndShrink) {
+        DynamicArray * da = DynamicArray_new();
+        DynamicArray_reserve(da, 1000);
+        ASSERT_LE(da->origin + 1000, da->capacity);
+        double * buffer = da->buffer;
+        for ( int i=0; i<1000; i++ ) {
+            DynamicArray_push(da, i);
+        }
+        ASSERT_EQ(buffer, da->buffer); /* no reallocation */
+        DynamicArray_shrink_to_fit(da);
+        ASSERT_EQ(1000, da->capacity);
+        ASSERT_EQ(0, (size_t) da->buffer % DYNAMIC_ARRAY_ALIGNMENT);
+        DynamicArray_push_front(da, -1);
+        DynamicArray_push(da, 1000);
+        ASSERT_EQ(1002, DynamicArray_size(da));
+        for ( int i=0; i<1002; i++ ) {
+            ASSERT_EQ(i - 1, DynamicArray_get(da, i));
+        }
+        DynamicArray_destroy(da);
+    }
+
+    TEST(DynamicArray, Statistics) {
+        DynamicArray * da = DynamicArray_new();
+        for ( int i=0; i<1003; i++ ) { /* not a multiple of the vector block */
+            DynamicArray_push(da, (i % 7) - 3.5 + 0.001 * i);
+        }
+        DynamicArray_set(da, 517, -100);
+        DynamicArray_set(da, 1001, 100);
+        ASSERT_DOUBLE_EQ(-100, DynamicArray_min(da));
+        ASSERT_DOUBLE_EQ(100, DynamicArray_max(da));
+        double expected = 0;
+        for ( int i=0; i<DynamicArray_size(da); i++ ) {
+            expected += DynamicArray_get(da, i);
+        }
+        ASSERT_NEAR(expected, DynamicArray_sum(da), 1e-9);
+        ASSERT_NEAR(expected / 1003, DynamicArray_mean(da), 1e-12);
+        DynamicArray_destroy(da);
+    }
+
+    TEST(DynamicArray, BulkOps) {
+        DynamicArray * x = DynamicArray_new(),
+                     * y = DynamicArray_new();
+        for ( int i=0; i<37; i++ ) {
+            DynamicArray_push(x, i - 18);
+            DynamicArray_push(y, 1);
+        }
+        DynamicArray * z = DynamicArray_map_op(x, DYNAMIC_ARRAY_ABS, 0);
+        ASSERT_EQ(37, DynamicArray_size(z));
+        for ( int i=0; i<37; i++ ) {
+            ASSERT_EQ(fabs(i - 18.0), DynamicArray_get(z, i));
+        }
+        DynamicArray_apply_op(z, DYNAMIC_ARRAY_MUL, 2);
+        ASSERT_EQ(36, DynamicArray_get(z, 0));
+        DynamicArray_axpy(3, x, y);
+        for ( int i=0; i<37; i++ ) {
+            ASSERT_EQ(3 * (i - 18.0) + 1, DynamicArray_get(y, i));
+        }
+        double dot = 0;
+        for ( int i=0; i<37; i++ ) {
+            dot += DynamicArray_get(x, i) * DynamicArray_get(y, i);
+        }
+        ASSERT_DOUBLE_EQ(dot, DynamicArray_dot(x, y));
+        DynamicArray_destroy(x);
+        DynamicArray_destroy(y);
+        DynamicArray_destroy(z);
+    }
+
+    TEST(DynamicArray, Quantiles) {
+        DynamicArray * da = DynamicArray_new();
+        DynamicArray_push(da, 7);
+        ASSERT_EQ(7, DynamicArray_median(da));
+        DynamicArray_push(da, 3);
+        ASSERT_EQ(5, DynamicArray_median(da));
+        DynamicArray_pop(da);
+        DynamicArray_pop(da);
+        /* 0, 1, ..., 999 shuffled, with many duplicates of 500 */
+        for ( int i=0; i<1000; i++ ) {
+            DynamicArray_push(da, (i * 389) % 1000);
+        }
+        for ( int i=0; i<200; i++ ) {
+            DynamicArray_push(da, 500);
+        }
+        double ps[] = { 0.99, 0, 0.5, 0.25, 1, 0.95, 0.5 },
+               result[7];
+        DynamicArray_quantiles(da, ps, 7, result);
+        double expected[] = { 987.01, 0, 500, 299.75, 999, 939.05, 500 };
+        for ( int i=0; i<7; i++ ) {
+            ASSERT_NEAR(expected[i], result[i], 1e-9);
+        }
+        ASSERT_NEAR(987.01, DynamicArray_quantile(da, 0.99), 1e-9);
+        ASSERT_EQ(500, DynamicArray_median(da));
+        ASSERT_EQ(389, DynamicArray_get(da, 1)); /* unchanged */
+        DynamicArray_destroy(da);
+    }
+
+    TEST(QuantileSketch, Estimates) {
+        QuantileSketch * s = QuantileSketch_new(0.95);
+        QuantileSketch_add(s, 2);
+        QuantileSketch_add(s, 1);
+        ASSERT_DOUBLE_EQ(1.95, QuantileSketch_get(s));
+        DynamicArray * da = DynamicArray_new();
+        QuantileSketch_add_array(s, da);
+        ASSERT_EQ(2, QuantileSketch_count(s));
+        for ( int i=0; i<100000; i++ ) {
+            QuantileSketch_push(s, da, (i * 7919) % 100000);
+        }
+        ASSERT_EQ(100002, QuantileSketch_count(s));
+        ASSERT_NEAR(DynamicArray_quantile(da, 0.95), QuantileSketch_get(s), 500);
+        QuantileSketch * median = QuantileSketch_new(0.5);
+        QuantileSketch_add_array(median, da);
+        ASSERT_NEAR(DynamicArray_median(da), QuantileSketch_get(median), 500);
+        QuantileSketch_destroy(s);
+        QuantileSketch_destroy(median);
+        DynamicArray_destroy(da);
+    }
+
+    double twice ( double x ) { return 2 * x; }
+    double plus ( double x, double y ) { return x + y; }
+    double times ( double x, double y ) { return x * y; }
+    int is_even ( double x ) { return ( (int) x ) % 2 == 0; }
+    double square ( double x ) { return x * x; }
+
+    TEST(DynamicArray, Pipeline) {
+        DynamicArray * da = DynamicArray_new(),
+                     * weights = DynamicArray_new();
+        for ( int i=0; i<10; i++ ) {
+            DynamicArray_push(da, i);
+        }
+        for ( int i=0; i<4; i++ ) {
+            DynamicArray_push(weights, i + 1);
+        }
+        DynamicArrayPipeline p = DynamicArray_pipeline(da);
+        ASSERT_EQ(45, DynamicArrayPipeline_sum(&p));
+        DynamicArrayPipeline_filter(&p, is_even);           /* 0 2 4 6 8 */
+        DynamicArrayPipeline_scan(&p, plus, 0);             /* 0 2 6 12 20 */
+        ASSERT_EQ(40, DynamicArrayPipeline_sum(&p));
+        ASSERT_EQ(5, DynamicArrayPipeline_count(&p));
+        DynamicArrayPipeline_zip(DynamicArrayPipeline_map(&p, twice), weights, times); /* 0 8 36 96 */
+        ASSERT_EQ(4, DynamicArrayPipeline_count(&p));
+        ASSERT_EQ(0, DynamicArrayPipeline_reduce(&p, times, 1));
+        DynamicArray * result = DynamicArrayPipeline_to_array(&p);
+        ASSERT_EQ(4, DynamicArray_size(result));
+        double expected[] = { 0, 8, 36, 96 };
+        for ( int i=0; i<4; i++ ) {
+            ASSERT_EQ(expected[i], DynamicArray_get(result, i));
+        }
+        ASSERT_EQ(10, DynamicArray_size(da)); /* source untouched */
+        DynamicArray * doubled = DynamicArray_map(da, twice);
+        ASSERT_EQ(18, DynamicArray_get(doubled, 9));
+        DynamicArray_destroy(da);
+        DynamicArray_destroy(weights);
+        DynamicArray_destroy(result);
+        DynamicArray_destroy(doubled);
+    }
+
+    TEST(DynamicArray, Arena) {
+        int before = DynamicArray_num_arrays();
+        DynamicArray * heap = DynamicArray_new();
+        ASSERT_EQ(before + 1, DynamicArray_num_arrays());
+        DynamicArrayArena * arena = DynamicArrayArena_new(4096);
+        DynamicArray * arrays[100];
+        for ( int i=0; i<100; i++ ) {
+            arrays[i] = DynamicArray_new_in(arena);
+            for ( int j=0; j<=i; j++ ) {
+                DynamicArray_push(arrays[i], j);
+            }
+            DynamicArray_push_front(arrays[i], -1);
+        }
+        ASSERT_EQ(before + 101, DynamicArray_num_arrays());
+        ASSERT_EQ(100, DynamicArrayArena_num_arrays(arena));
+        for ( int i=0; i<100; i++ ) {
+            ASSERT_EQ(i + 2, DynamicArray_size(arrays[i]));
+            ASSERT_EQ(-1, DynamicArray_get(arrays[i], 0));
+            ASSERT_EQ(i, DynamicArray_get(arrays[i], i + 1));
+            ASSERT_EQ(0, (size_t) arrays[i]->buffer % DYNAMIC_ARRAY_ALIGNMENT);
+        }
+        DynamicArray * doubled = DynamicArray_map_op(arrays[99], DYNAMIC_ARRAY_MUL, 2);
+        ASSERT_EQ(arena, doubled->arena);
+        ASSERT_EQ(198, DynamicArray_get(doubled, 100));
+        DynamicArray_destroy(arrays[0]);
+        ASSERT_EQ(0, DynamicArray_is_valid(arrays[0]));
+        ASSERT_EQ(1, DynamicArray_is_valid(arrays[1]));
+        ASSERT_EQ(100, DynamicArrayArena_num_arrays(arena));
+        DynamicArrayArena_reset(arena);
+        ASSERT_EQ(before + 1, DynamicArray_num_arrays());
+        DynamicArray * again = DynamicArray_new_in(arena);
+        DynamicArray_push(again, X);
+        ASSERT_EQ(X, DynamicArray_pop(again));
+        DynamicArrayArena_destroy(arena);
+        DynamicArray_destroy(heap);
+        free(heap);
+        ASSERT_EQ(before, DynamicArray_num_arrays());
+    }
+
+    TEST(DynamicArray, Slices) {
+        DynamicArray * da = DynamicArray_new();
+        for ( int i=0; i<20; i++ ) {
+            DynamicArray_push(da, i);
+        }
+        DynamicArraySlice s = DynamicArray_slice(da, 3, 18, 4); /* 3 7 11 15 */
+        ASSERT_EQ(4, DynamicArraySlice_size(s));
+        ASSERT_EQ(11, DynamicArraySlice_get(s, 2));
+        ASSERT_EQ(36, DynamicArraySlice_sum(s));
+        ASSERT_EQ(9, DynamicArraySlice_mean(s));
+        ASSERT_EQ(3, DynamicArraySlice_min(s));
+        ASSERT_EQ(15, DynamicArraySlice_max(s));
+        DynamicArraySlice t = DynamicArraySlice_slice(s, 1, 4, 2); /* 7 15 */
+        ASSERT_EQ(2, DynamicArraySlice_size(t));
+        ASSERT_EQ(15, DynamicArraySlice_get(t, 1));
+        char * str = DynamicArraySlice_to_string(t);
+        ASSERT_STREQ("[7,15]", str);
+        free(str);
+        DynamicArraySlice window = DynamicArray_slice(da, 10, 15, 1);
+        for ( int i=0; i<1000; i++ ) {
+            DynamicArray_push(da, 0); /* the buffer moves, the view follows */
+        }
+        ASSERT_EQ(60, DynamicArraySlice_sum(window));
+        ASSERT_EQ(14, DynamicArraySlice_max(window));
+        DynamicArray * squares = DynamicArraySlice_map(t, square);
+        ASSERT_EQ(2, DynamicArray_size(squares));
+        ASSERT_EQ(225, DynamicArray_get(squares, 1));
+        DynamicArray * sub = DynamicArray_subarray(da, 5, 8),
+                     * past = DynamicArray_subarray(da, 1018, 1022),
+                     * copy = DynamicArray_copy(sub),
+                     * both = DynamicArray_concat(sub, copy);
+        ASSERT_EQ(3, DynamicArray_size(sub));
+        ASSERT_EQ(7, DynamicArray_get(sub, 2));
+        ASSERT_EQ(4, DynamicArray_size(past));
+        ASSERT_EQ(0, DynamicArray_get(past, 3));
+        ASSERT_EQ(6, DynamicArray_size(both));
+        ASSERT_EQ(5, DynamicArray_get(both, 3));
+        DynamicArrayRope * rope = DynamicArrayRope_new();
+        DynamicArrayRope_append(rope, s);                       /* 3 7 11 15 */
+        DynamicArrayRope_append(rope, DynamicArray_view(sub));  /* 5 6 7 */
+        DynamicArrayRope * other = DynamicArrayRope_new();
+        DynamicArrayRope_append(other, window);                 /* 10 ... 14 */
+        DynamicArrayRope_concat(rope, other);
+        ASSERT_EQ(12, DynamicArrayRope_size(rope));
+        ASSERT_EQ(36 + 18 + 60, DynamicArrayRope_sum(rope));
+        double expected[] = { 3, 7, 11, 15, 5, 6, 7, 10, 11, 12, 13, 14 };
+        DynamicArray * flat = DynamicArrayRope_to_array(rope);
+        for ( int i=0; i<12; i++ ) {
+            ASSERT_EQ(expected[i], DynamicArrayRope_get(rope, i));
+            ASSERT_EQ(expected[i], DynamicArray_get(flat, i));
+        }
+        DynamicArrayRope_destroy(rope);
+        DynamicArrayRope_destroy(other);
+        DynamicArray * arrays[] = { da, squares, sub, past, copy, both, flat };
+        for ( int i=0; i<7; i++ ) {
+            DynamicArray_destroy(arrays[i]);
+            free(arrays[i]);
+        }
+    }
+
+    void count_chunks ( const char *, int length, void * context ) {
+        ( (int *) context )[0]++;
+        ( (int *) context )[1] += length;
+    }
+
+    TEST(DynamicArray, Writer) {
+        char out[DYNAMIC_ARRAY_DOUBLE_CHARS];
+        double values[] = { 0.1, 1.0 / 3, 5e-324, 1.7976931348623157e308, 123456.0, 1e21,
+                            -2.5, 0.001, 1e-5, 4503599627370497.0 };
+        const char * expected[] = { "0.1", "0.3333333333333333", "5e-324", "1.7976931348623157e+308",
+                                    "123456", "1e+21", "-2.5", "0.001", "1e-05", "4.503599627370497e+15" };
+        for ( int i=0; i<10; i++ ) {
+            int n = DynamicArray_format_double(values[i], out);
+            out[n] = '\0';
+            ASSERT_STREQ(expected[i], out);
+        }
+        /* Round trips */
+        unsigned long long bits = 0x9E3779B97F4A7C15ULL;
+        for ( int i=0; i<100000; i++ ) {
+            bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+            double x;
+            memcpy(&x, &bits, sizeof(x));
+            if ( x != x || isinf(x) ) {
+                continue;
+            }
+            int n = DynamicArray_format_double(x, out);
+            out[n] = '\0';
+            ASSERT_EQ(x, strtod(out, NULL)) << out;
+        }
+
+        DynamicArray * da = DynamicArray_new();
+        for ( int i=0; i<1000; i++ ) {
+            DynamicArray_push(da, i / 4.0);
+        }
+        char small[16];
+        DynamicArrayWriter w = DynamicArrayWriter_to_buffer(small, sizeof(small));
+        DynamicArray_write(da, &w);
+        long total = DynamicArrayWriter_finish(&w);
+        ASSERT_TRUE(w.overflow);
+        ASSERT_STREQ("[0,0.25,0.5,0.7", small);
+        char * str = DynamicArray_to_string(da);
+        ASSERT_EQ(total, (long) strlen(str));
+        ASSERT_EQ(0, strncmp(str, "[0,0.25,0.5,0.75,1,1.25", 23));
+
+        int chunks[2] = { 0, 0 };
+        char chunk[64];
+        w = DynamicArrayWriter_to_sink(count_chunks, chunks, chunk, sizeof(chunk));
+        DynamicArray_write(da, &w);
+        ASSERT_EQ(total, DynamicArrayWriter_finish(&w));
+        ASSERT_EQ(total, chunks[1]);
+        ASSERT_LE(total / 64, chunks[0]);
+
+        FILE * f = tmpfile();
+        w = DynamicArrayWriter_to_file(f, chunk, sizeof(chunk));
+        DynamicArray_write(da, &w);
+        DynamicArrayWriter_finish(&w);
+        ASSERT_EQ(total, ftell(f));
+        rewind(f);
+        char * back = (char *) calloc(total + 1, 1);
+        ASSERT_EQ(total, (long) fread(back, 1, total, f));
+        ASSERT_STREQ(str, back);
+        fclose(f);
+        free(back);
+        free(str);
+        DynamicArray_destroy(da);
+    }
+
+    TEST(DynamicArray, Mapped) {
+        char path[] = "/tmp/dynamic_array_XXXXXX";
+        close(mkstemp(path));
+        DynamicArray * da = DynamicArray_open_mapped(path);
+        ASSERT_TRUE(da != NULL);
+        ASSERT_EQ(0, DynamicArray_size(da));
+        for ( int i=0; i<10000; i++ ) {
+            DynamicArray_push(da, i);
+        }
+        for ( int i=1; i<=100; i++ ) {
+            DynamicArray_push_front(da, -i);
+        }
+        DynamicArray_set(da, 10200, 1);
+        ASSERT_EQ(10201, DynamicArray_size(da));
+        ASSERT_EQ(0, DynamicArray_get(da, 10150));
+        DynamicArray_sync(da);
+        DynamicArray_shrink_to_fit(da);
+        DynamicArray_destroy(da);
+        free(da);
+
+        struct stat st;
+        stat(path, &st);
+        ASSERT_EQ(DYNAMIC_ARRAY_FILE_HEADER + 10201 * sizeof(double), (size_t) st.st_size);
+
+        da = DynamicArray_open_mapped(path);
+        ASSERT_TRUE(da != NULL);
+        ASSERT_EQ(10201, DynamicArray_size(da));
+        ASSERT_EQ(-100, DynamicArray_get(da, 0));
+        ASSERT_EQ(9999, DynamicArray_get(da, 10099));
+        ASSERT_EQ(1, DynamicArray_get(da, 10200));
+        ASSERT_EQ(9999 * 10000 / 2 - 101 * 100 / 2 + 1, DynamicArray_sum(da));
+        ASSERT_EQ(1, DynamicArray_pop(da));
+        DynamicArray_destroy(da);
+        free(da);
+
+        /* Not an array file */
+        FILE * f = fopen(path, "w");
+        fprintf(f, "1,2,3\n");
+        fclose(f);
+        ASSERT_TRUE(DynamicArray_open_mapped(path) == NULL);
+        ASSERT_TRUE(DynamicArray_open_mapped("/nonexistent/dir/file") == NULL);
+        unlink(path);
+    }
+
     TEST(ArbitraryArray,OfPointers) {
 
         // Create the array that will hold the pointers
@@ -49,6 +446,30 @@ namespace {
         ASSERT_NE(*ptr_b, a);        
     }
 
+    TEST(ArbitraryArray,Typed) {
+        PointArray * a = PointArray_new();
+        for ( int i=0; i<100; i++ ) {
+            Point p = { (double) i, 2.0 * i, 3.0 * i };
+            PointArray_push(a, p);
+        }
+        ASSERT_EQ(100, PointArray_size(a));
+        ASSERT_EQ(42, PointArray_get(a, 42).x);
+        PointArray_get_ptr(a, 42)->z = -1;
+        ASSERT_EQ(-1, PointArray_data(a)[42].z);
+        ASSERT_TRUE(PointArray_get_ptr(a, 100) == NULL);
+
+        /* The same array through the generic interface */
+        ArbitraryArray * generic = PointArray_arbitrary(a);
+        ASSERT_EQ(100, ArbitraryArray_size(generic));
+        Point * p = (Point *) ArbitraryArray_get_ptr(generic, 7);
+        ASSERT_EQ(14, p->y);
+        Point q = { 1, 2, 3 };
+        ArbitraryArray_set_from_ptr(generic, 150, &q);
+        ASSERT_EQ(151, PointArray_size(a));
+        ASSERT_EQ(3, PointArray_get(a, 150).z);
+        PointArray_destroy(a);
+    }
+
 //     TEST(DynamicArray, SmallIndex) {
 //         DynamicArray * da = DynamicArray_new();
 //         ASSERT_EQ(DynamicArray_size(da),0);
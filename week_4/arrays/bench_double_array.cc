@@ -0,0 +1,49 @@
+#include <iostream>
+#include <chrono>
+#include "double_array.h"
+
+// Evaluates y = 0.5 * x * x - 3 * x + 2 over 10M samples, once with get and
+// set on every element and once as an expression, which runs as one fused
+// loop with no temporaries. Also times the range constructor, which now
+// allocates once. Build and run with make bench.
+
+const double N = 1e7;
+const int REPS = 10;
+
+static double seconds() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main() {
+
+    double t0 = seconds();
+    DoubleArray x(0, N - 1, 1);
+    double t1 = seconds();
+    std::cout << "range constructor, " << x.size() << " elements: " << (t1 - t0) << " s" << std::endl;
+
+    DoubleArray y, z;
+    double check = 0;
+
+    t0 = seconds();
+    for ( int r=0; r<REPS; r++ ) {
+        for ( int i=0; i<x.size(); i++ ) {
+            double v = x.get(i);
+            y.set(i, 0.5 * v * v - 3 * v + 2);
+        }
+        check += y.get(x.size() - 1);
+    }
+    t1 = seconds();
+    for ( int r=0; r<REPS; r++ ) {
+        z = 0.5 * x * x - 3 * x + 2;
+        check -= z.get(x.size() - 1);
+    }
+    double t2 = seconds();
+
+    std::cout << "get/set loop: " << (t1 - t0) / REPS << " s per pass" << std::endl;
+    std::cout << "expression:   " << (t2 - t1) / REPS << " s per pass" << std::endl;
+    std::cout << "(check " << check << ")" << std::endl;
+
+    return 0;
+
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include "typed_array.h"
+#include "typed_matrix.h"
+
+// Compares matrix multiply and transpose on a contiguous TypedMatrix with the
+// same operations on a TypedArray of TypedArrays, for the small matrices of a
+// control loop (many repetitions) and for larger ones. Build and run with
+// make bench.
+
+typedef TypedArray<TypedArray<double>> Nested;
+
+static double seconds() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static Nested nested(int n) {
+    Nested m;
+    for ( int i=0; i<n; i++ ) {
+        for ( int j=0; j<n; j++ ) {
+            m.get(i).set(j, (i + 2 * j) % 7);
+        }
+    }
+    return m;
+}
+
+static Nested nested_multiply(Nested &a, Nested &b, int n) {
+    Nested c;
+    for ( int i=0; i<n; i++ ) {
+        for ( int j=0; j<n; j++ ) {
+            double sum = 0;
+            for ( int k=0; k<n; k++ ) {
+                sum += a.get(i).get(k) * b.get(k).get(j);
+            }
+            c.get(i).set(j, sum);
+        }
+    }
+    return c;
+}
+
+static Nested nested_transpose(Nested &a, int n) {
+    Nested t;
+    for ( int i=0; i<n; i++ ) {
+        for ( int j=0; j<n; j++ ) {
+            t.get(j).set(i, a.get(i).get(j));
+        }
+    }
+    return t;
+}
+
+static void run(int n, int reps) {
+
+    Nested na = nested(n), nb = nested(n);
+    TypedMatrix<double> a(n, n), b(n, n);
+    for ( int i=0; i<n; i++ ) {
+        for ( int j=0; j<n; j++ ) {
+            a(i, j) = b(i, j) = (i + 2 * j) % 7;
+        }
+    }
+
+    double check = 0, t0, t1, t2, t3, t4;
+
+    t0 = seconds();
+    for ( int r=0; r<reps; r++ ) {
+        check += nested_multiply(na, nb, n).get(n-1).get(n-1);
+    }
+    t1 = seconds();
+    for ( int r=0; r<reps; r++ ) {
+        check -= (a * b)(n-1, n-1);
+    }
+    t2 = seconds();
+    for ( int r=0; r<reps; r++ ) {
+        check += nested_transpose(na, n).get(0).get(n-1);
+    }
+    t3 = seconds();
+    for ( int r=0; r<reps; r++ ) {
+        check -= a.transpose()(0, n-1);
+    }
+    t4 = seconds();
+
+    std::cout << n << "x" << n << ", " << reps << " repetitions" << std::endl;
+    std::cout << "  multiply   nested " << (t1 - t0) << " s, matrix " << (t2 - t1) << " s" << std::endl;
+    std::cout << "  transpose  nested " << (t3 - t2) << " s, matrix " << (t4 - t3) << " s" << std::endl;
+    std::cout << "  (check " << check << ")" << std::endl;
+
+}
+
+int main() {
+    run(4, 200000);
+    run(16, 20000);
+    run(256, 2);
+    run(512, 1);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "typed_array.h"
+#include "typed_array_parallel.h"
+
+// Times parallel_sort, parallel_transform and parallel_reduce on 100M doubles
+// with 1, 2, 4 and 8 threads. The speedup is bounded by the number of cores
+// (printed first) and, for transform and reduce, by memory bandwidth. Build
+// and run with make bench.
+
+const int N = 100000000;
+
+static double seconds() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void fill(TypedArray<double> &a) {
+    unsigned long long x = 88172645463325252ull;
+    for ( auto &v : a ) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        v = (double) (x >> 11) / (double) (1ull << 53);
+    }
+}
+
+int main() {
+
+    std::cout << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    TypedArray<double> a(N, 0.0), b(N, 0.0);
+    double check = 0;
+
+    for ( int threads=1; threads<=8; threads*=2 ) {
+
+        fill(a);
+
+        double t0 = seconds();
+        parallel_transform(a, b, [](double x) { return std::sqrt(x) * 2 + 1; }, threads);
+        double t1 = seconds();
+        check += parallel_reduce(b, 0.0, std::plus<double>(), threads);
+        double t2 = seconds();
+        parallel_sort(a, std::less<double>(), threads);
+        double t3 = seconds();
+        check += a[N / 2];
+
+        std::cout << threads << " threads: transform " << (t1 - t0)
+                  << " s, reduce " << (t2 - t1)
+                  << " s, sort " << (t3 - t2) << " s" << std::endl;
+
+    }
+
+    std::cout << "(check " << check << ")" << std::endl;
+    return 0;
+
+}
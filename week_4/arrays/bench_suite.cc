@@ -0,0 +1,58 @@
+#include <numeric>
+#include <benchmark/benchmark.h>
+#include "typed_array.h"
+
+// Google Benchmark suite for TypedArray push, get and sum throughput. Run it
+// with make json to write the results to bench_suite.json, which can be
+// compared between commits. It is also run, with console output, by make
+// bench.
+
+namespace {
+
+    void BM_Push(benchmark::State& state) {
+        for ( auto _ : state ) {
+            TypedArray<double> a;
+            for ( int i=0; i<state.range(0); i++ ) {
+                a.emplace_back(i);
+            }
+            benchmark::DoNotOptimize(a.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Push)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+    TypedArray<double> filled(int n) {
+        TypedArray<double> a;
+        for ( int i=0; i<n; i++ ) {
+            a.emplace_back(i);
+        }
+        return a;
+    }
+
+    // Checked access through safe_get
+    void BM_Get(benchmark::State& state) {
+        TypedArray<double> a = filled(state.range(0));
+        for ( auto _ : state ) {
+            double total = 0;
+            for ( int i=0; i<a.size(); i++ ) {
+                total += a.safe_get(i);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Get)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+    // Unchecked access through the iterators
+    void BM_Sum(benchmark::State& state) {
+        TypedArray<double> a = filled(state.range(0));
+        for ( auto _ : state ) {
+            benchmark::DoNotOptimize(std::accumulate(a.begin(), a.end(), 0.0));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Sum)->RangeMultiplier(16)->Range(16, 1 << 20);
+
+}
+
+BENCHMARK_MAIN();
@@ -10,12 +10,22 @@ DoubleArray::DoubleArray() {
     end = origin;
 }
 
-// Range constructor
-DoubleArray::DoubleArray(double a, double b, double step) : DoubleArray() {
-    int i = 0;
+// Range constructor. The elements are counted first so that the buffer is
+// allocated once, at its final size. x is accumulated the same way in both
+// loops so that they agree on the last element.
+DoubleArray::DoubleArray(double a, double b, double step) : buffer(nullptr) {
+    if ( step <= 0 ) {
+        throw std::invalid_argument("Non-positive step in range");
+    }
+    int n = 0;
     for ( double x=a; x<=b; x += step ) {
-        set(i, x);
-        i+=1;
+        n++;
+    }
+    allocate_exactly(n);
+    double x = a;
+    for ( int i=0; i<n; i++ ) {
+        buffer[i] = x;
+        x += step;
     }
 }
 
@@ -39,6 +49,10 @@ DoubleArray& DoubleArray::operator=(const DoubleArray& other) {
     return *this;
 }
 
+DoubleArray& DoubleArray::operator*=(double a) {
+    return *this = *this * a;
+}
+
 // Destructor
 DoubleArray::~DoubleArray() {
     delete[] buffer;
@@ -90,6 +104,16 @@ bool DoubleArray::out_of_buffer ( int offset ) const {
     return offset < 0 || offset >= capacity;
 }
 
+/* Replaces the buffer with one holding exactly size elements, starting at
+   the beginning of the buffer, all zero */
+void DoubleArray::allocate_exactly(int size) {
+    delete[] buffer;
+    capacity = size > 0 ? size : 1;
+    buffer = new double[capacity]();
+    origin = 0;
+    end = size;
+}
+
 /* Makes a new buffer that is twice the size of the old buffer,
    copies the old information into the new buffer, and deletes
    the old buffer */
@@ -2,8 +2,10 @@
 #define DOUBLE_ARRAY
 
 #include <iostream>
+#include <stdexcept>
+#include "double_array_expression.h"
 
-class DoubleArray {
+class DoubleArray : public DoubleArrayExpression<DoubleArray> {
 
 public:
 
@@ -12,9 +14,27 @@ public:
     DoubleArray(double a, double b, double step); // Range constructor
     DoubleArray(const DoubleArray& other); // Copy constructor
 
+    // Evaluates an arithmetic expression over arrays, e.g. DoubleArray c = a + 2 * b,
+    // in one loop into a buffer of exactly the right size
+    template <typename E>
+    DoubleArray(const DoubleArrayExpression<E>& expression);
+
     // Assignment
     DoubleArray& operator=(const DoubleArray& other);
 
+    // Assigns an expression, which may refer to this array: a = a * b
+    // updates a in place
+    template <typename E>
+    DoubleArray& operator=(const DoubleArrayExpression<E>& expression);
+
+    template <typename E>
+    DoubleArray& operator+=(const DoubleArrayExpression<E>& expression);
+
+    template <typename E>
+    DoubleArray& operator-=(const DoubleArrayExpression<E>& expression);
+
+    DoubleArray& operator*=(double a);
+
     // Destructor
     ~DoubleArray();
 
@@ -22,6 +42,9 @@ public:
     double get(int index) const;
     int size() const;
 
+    // Unchecked access, used when evaluating expressions
+    double operator[](int index) const { return buffer[origin + index]; }
+
     // Setters
     void set(int index, double value);
 
@@ -39,7 +62,55 @@ private:
     int offset_to_index(int offset) const;
     bool out_of_buffer(int offset) const;
     void extend_buffer(void);
+    void allocate_exactly(int size);
+
+    template <typename E>
+    void evaluate(const DoubleArrayExpression<E>& expression);
 
 };
 
+template <typename E>
+DoubleArray::DoubleArray(const DoubleArrayExpression<E>& expression) : buffer(nullptr) {
+    allocate_exactly(expression.size());
+    evaluate(expression);
+}
+
+// When the size changes the expression is evaluated into the new buffer
+// before the old one, which it may refer to, is freed
+template <typename E>
+DoubleArray& DoubleArray::operator=(const DoubleArrayExpression<E>& expression) {
+    if ( expression.size() == size() ) {
+        evaluate(expression);
+    } else {
+        DoubleArray result(expression);
+        std::swap(buffer, result.buffer);
+        std::swap(capacity, result.capacity);
+        std::swap(origin, result.origin);
+        std::swap(end, result.end);
+    }
+    return *this;
+}
+
+template <typename E>
+DoubleArray& DoubleArray::operator+=(const DoubleArrayExpression<E>& expression) {
+    return *this = *this + expression;
+}
+
+template <typename E>
+DoubleArray& DoubleArray::operator-=(const DoubleArrayExpression<E>& expression) {
+    return *this = *this - expression;
+}
+
+// One pass over the elements; each element of the result depends only on
+// the same element of the operands, so in-place evaluation is safe
+template <typename E>
+void DoubleArray::evaluate(const DoubleArrayExpression<E>& expression) {
+    const E& e = expression.self();
+    double * x = buffer + origin;
+    int n = size();
+    for ( int i=0; i<n; i++ ) {
+        x[i] = e[i];
+    }
+}
+
 #endif
\ No newline at end of file
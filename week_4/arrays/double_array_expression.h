@@ -0,0 +1,106 @@
+#ifndef DOUBLE_ARRAY_EXPRESSION
+#define DOUBLE_ARRAY_EXPRESSION
+
+#include <stdexcept>
+
+// Expression templates for elementwise arithmetic on DoubleArrays. An
+// expression like a + 2 * b * c does no arithmetic: it builds a small tree of
+// nodes that records the operations. Assigning it to a DoubleArray runs a
+// single loop that evaluates the whole tree at each index, so there are no
+// temporary arrays and the compiler can inline and vectorize the loop.
+//
+// Nodes hold DoubleArrays by reference and other nodes by value, so an
+// expression must be assigned within the statement that builds it. Do not
+// keep one in an auto variable.
+
+class DoubleArray;
+
+// Base of every expression, including DoubleArray itself. E is the derived
+// type, which has size() and an unchecked operator[].
+template <typename E>
+class DoubleArrayExpression {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+    int size() const { return self().size(); }
+    double operator[](int i) const { return self()[i]; }
+};
+
+// How a node stores an operand: arrays by reference, nodes by value
+template <typename E>
+struct DoubleArrayOperand { typedef const E type; };
+
+template <>
+struct DoubleArrayOperand<DoubleArray> { typedef const DoubleArray& type; };
+
+// A scalar operand, which has the size of whatever it is combined with
+class DoubleArrayScalar : public DoubleArrayExpression<DoubleArrayScalar> {
+public:
+    DoubleArrayScalar(double value) : value(value) {}
+    int size() const { return -1; }
+    double operator[](int) const { return value; }
+private:
+    double value;
+};
+
+template <typename L, typename R, typename Op>
+class DoubleArrayBinary : public DoubleArrayExpression<DoubleArrayBinary<L, R, Op>> {
+public:
+    DoubleArrayBinary(const L& left, const R& right) : left(left), right(right) {
+        if ( left.size() >= 0 && right.size() >= 0 && left.size() != right.size() ) {
+            throw std::invalid_argument("Array sizes do not match");
+        }
+    }
+    int size() const { return left.size() >= 0 ? left.size() : right.size(); }
+    double operator[](int i) const { return Op::apply(left[i], right[i]); }
+private:
+    typename DoubleArrayOperand<L>::type left;
+    typename DoubleArrayOperand<R>::type right;
+};
+
+template <typename E>
+class DoubleArrayNegate : public DoubleArrayExpression<DoubleArrayNegate<E>> {
+public:
+    DoubleArrayNegate(const E& operand) : operand(operand) {}
+    int size() const { return operand.size(); }
+    double operator[](int i) const { return -operand[i]; }
+private:
+    typename DoubleArrayOperand<E>::type operand;
+};
+
+struct DoubleArrayAdd { static double apply(double x, double y) { return x + y; } };
+struct DoubleArraySubtract { static double apply(double x, double y) { return x - y; } };
+struct DoubleArrayMultiply { static double apply(double x, double y) { return x * y; } };
+struct DoubleArrayDivide { static double apply(double x, double y) { return x / y; } };
+
+// Each operator combines two expressions, an expression and a scalar, or a
+// scalar and an expression
+#define DOUBLE_ARRAY_OPERATOR(symbol, Op)                                                   \
+    template <typename L, typename R>                                                       \
+    DoubleArrayBinary<L, R, Op> operator symbol(const DoubleArrayExpression<L>& left,       \
+                                                const DoubleArrayExpression<R>& right) {    \
+        return DoubleArrayBinary<L, R, Op>(left.self(), right.self());                      \
+    }                                                                                       \
+    template <typename L>                                                                   \
+    DoubleArrayBinary<L, DoubleArrayScalar, Op> operator symbol(                            \
+            const DoubleArrayExpression<L>& left, double right) {                           \
+        return DoubleArrayBinary<L, DoubleArrayScalar, Op>(left.self(), right);             \
+    }                                                                                       \
+    template <typename R>                                                                   \
+    DoubleArrayBinary<DoubleArrayScalar, R, Op> operator symbol(                            \
+            double left, const DoubleArrayExpression<R>& right) {                           \
+        return DoubleArrayBinary<DoubleArrayScalar, R, Op>(left, right.self());             \
+    }
+
+DOUBLE_ARRAY_OPERATOR(+, DoubleArrayAdd)
+DOUBLE_ARRAY_OPERATOR(-, DoubleArraySubtract)
+DOUBLE_ARRAY_OPERATOR(*, DoubleArrayMultiply)
+DOUBLE_ARRAY_OPERATOR(/, DoubleArrayDivide)
+
+#undef DOUBLE_ARRAY_OPERATOR
+
+template <typename E>
+DoubleArrayNegate<E> operator-(const DoubleArrayExpression<E>& operand) {
+    return DoubleArrayNegate<E>(operand.self());
+}
+
+#endif
@@ -2,19 +2,40 @@
 #define TYPED_ARRAY
 
 #include <assert.h>
+#include <string.h>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
-template <typename ElementType>
+// A growable array of ElementType, with room to grow at both ends. Storage
+// comes from Allocator and is left uninitialized until elements are put in
+// it: only the elements in [origin, finish) of the buffer are constructed.
+template <typename ElementType, typename Allocator = std::allocator<ElementType>>
 class TypedArray {
 
 public:
 
-    TypedArray();
+    // Iterators are pointers into the buffer, so they are random access and
+    // work with <algorithm>. Like data(), they are invalidated when the
+    // array grows.
+    typedef ElementType value_type;
+    typedef ElementType * iterator;
+    typedef const ElementType * const_iterator;
+
+    TypedArray(const Allocator& allocator = Allocator());
     TypedArray(const TypedArray& other);
 
-    // Copy constructor
+    // An array of size copies of value, in a buffer of exactly that size
+    TypedArray(int size, const ElementType& value, const Allocator& allocator = Allocator());
+
+    // Move constructor: takes other's buffer and leaves it empty
+    TypedArray(TypedArray&& other) noexcept;
+
+    // Assignment
     TypedArray& operator=(const TypedArray& other);
+    TypedArray& operator=(TypedArray&& other) noexcept;
 
     // Destructor
     ~TypedArray();
@@ -23,111 +44,286 @@ public:
     ElementType &get(int index);
     ElementType &safe_get(int index) const;
     int size() const;
+    Allocator get_allocator() const;
+
+    // The elements, which are contiguous. The pointer is invalidated when
+    // the array grows.
+    ElementType * data();
+    const ElementType * data() const;
+
+    // Unchecked access, for inner loops. Unlike get, an index outside
+    // [0, size()) is undefined behaviour rather than growing the array.
+    ElementType &operator[](int index);
+    const ElementType &operator[](int index) const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
 
     // Setters
     void set(int index, ElementType value);
 
+    // Construct an element in place at the back or the front, from the
+    // arguments of one of ElementType's constructors
+    template <typename... Args>
+    ElementType &emplace_back(Args&&... args);
+
+    template <typename... Args>
+    ElementType &emplace_front(Args&&... args);
+
 private:
 
+    typedef std::allocator_traits<Allocator> traits;
+
     int capacity,
         origin,
-        end;
+        finish;
 
-    ElementType * buffer;   
+    ElementType * buffer;
+
+    Allocator allocator;
 
     const int INITIAL_CAPACITY = 10;
 
     int index_to_offset(int index) const;
     int offset_to_index(int offset) const;
     bool out_of_buffer(int offset) const;
-    void extend_buffer(void);    
+    void extend_buffer(void);
+    void release(void);
+    void relocate(ElementType * to, std::true_type trivially_copyable);
+    void relocate(ElementType * to, std::false_type trivially_copyable);
 
 };
 
-template <typename ElementType>
-TypedArray<ElementType>::TypedArray() {
-    buffer = new ElementType[INITIAL_CAPACITY]();
-    capacity = INITIAL_CAPACITY;    
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>::TypedArray(const Allocator& allocator) : allocator(allocator) {
+    buffer = traits::allocate(this->allocator, INITIAL_CAPACITY);
+    capacity = INITIAL_CAPACITY;
     origin = capacity / 2;
-    end = origin;    
+    finish = origin;
+}
+
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>::TypedArray(int size, const ElementType& value, const Allocator& allocator)
+  : allocator(allocator) {
+    if ( size < 0 ) {
+        throw std::range_error("Negative size for array");
+    }
+    capacity = size > 0 ? size : 1;
+    buffer = traits::allocate(this->allocator, capacity);
+    origin = finish = 0;
+    try {
+        for ( ; finish < size; finish++ ) {
+            traits::construct(this->allocator, buffer + finish, value);
+        }
+    } catch (...) {
+        release();
+        throw;
+    }
 }
 
 // Copy constructor: i.e TypedArray b(a) where a is a TypedArray
-template <typename ElementType>
-TypedArray<ElementType>::TypedArray(const TypedArray& other) : TypedArray() {
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>::TypedArray(const TypedArray& other)
+  : buffer(nullptr), allocator(traits::select_on_container_copy_construction(other.allocator)) {
     *this = other;
 }
 
+// Move constructor: i.e. TypedArray b(std::move(a)), or returning a TypedArray
+// from a function. No elements are copied or moved.
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>::TypedArray(TypedArray&& other) noexcept
+  : capacity(other.capacity), origin(other.origin), finish(other.finish),
+    buffer(other.buffer), allocator(std::move(other.allocator)) {
+    other.buffer = nullptr;
+    other.capacity = other.origin = other.finish = 0;
+}
+
 // Assignment operator: i.e TypedArray b = a 
-template <typename ElementType>
-TypedArray<ElementType>& TypedArray<ElementType>::operator=(const TypedArray<ElementType>& other) {
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>& TypedArray<ElementType, Allocator>::operator=(const TypedArray& other) {
     if ( this != &other) {
-        delete[] buffer; // don't forget this or you'll get a memory leak!
-        buffer = new ElementType[other.capacity]();
+        release(); // don't forget this or you'll get a memory leak!
+        buffer = traits::allocate(allocator, other.capacity);
         capacity = other.capacity;
         origin = other.origin;
-        end = origin;
-        for ( int i=0; i<other.size(); i++) {
-            set(i,other.safe_get(i));
+        finish = origin;
+        for ( ; finish < other.finish; finish++ ) {
+            traits::construct(allocator, buffer + finish, other.buffer[finish]);
         }
     }
     return *this;
 }
 
+// Move assignment: i.e. b = std::move(a)
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>& TypedArray<ElementType, Allocator>::operator=(TypedArray&& other) noexcept {
+    if ( this != &other ) {
+        release();
+        buffer = other.buffer;
+        capacity = other.capacity;
+        origin = other.origin;
+        finish = other.finish;
+        allocator = std::move(other.allocator);
+        other.buffer = nullptr;
+        other.capacity = other.origin = other.finish = 0;
+    }
+    return *this;
+}
+
 // Destructor
-template <typename ElementType>
-TypedArray<ElementType>::~TypedArray() {
-    delete[] buffer;
+template <typename ElementType, typename Allocator>
+TypedArray<ElementType, Allocator>::~TypedArray() {
+    release();
 }
 
 // Getters
-template <typename ElementType>
-ElementType &TypedArray<ElementType>::get(int index) {
+template <typename ElementType, typename Allocator>
+ElementType &TypedArray<ElementType, Allocator>::get(int index) {
     if (index < 0) {
         throw std::range_error("Out of range index in array");
     }
     if ( index >= size() ) {
         ElementType x;
-        set(index, x);
+        set(index, std::move(x));
     } 
     return buffer[index_to_offset(index)];
 }
 
 // Getters
-template <typename ElementType>
-ElementType &TypedArray<ElementType>::safe_get(int index) const {
+template <typename ElementType, typename Allocator>
+ElementType &TypedArray<ElementType, Allocator>::safe_get(int index) const {
     if (index < 0 || index >= size() ) {
         throw std::range_error("Out of range index in array");
     }
     return buffer[index_to_offset(index)];
 }
 
-template <typename ElementType>
-int TypedArray<ElementType>::size() const {
-    return end - origin;
+template <typename ElementType, typename Allocator>
+int TypedArray<ElementType, Allocator>::size() const {
+    return finish - origin;
+}
+
+template <typename ElementType, typename Allocator>
+Allocator TypedArray<ElementType, Allocator>::get_allocator() const {
+    return allocator;
+}
+
+template <typename ElementType, typename Allocator>
+ElementType * TypedArray<ElementType, Allocator>::data() {
+    return buffer + origin;
+}
+
+template <typename ElementType, typename Allocator>
+const ElementType * TypedArray<ElementType, Allocator>::data() const {
+    return buffer + origin;
+}
+
+template <typename ElementType, typename Allocator>
+ElementType &TypedArray<ElementType, Allocator>::operator[](int index) {
+    return buffer[origin + index];
+}
+
+template <typename ElementType, typename Allocator>
+const ElementType &TypedArray<ElementType, Allocator>::operator[](int index) const {
+    return buffer[origin + index];
+}
+
+// Iterators
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::iterator TypedArray<ElementType, Allocator>::begin() {
+    return buffer + origin;
+}
+
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::iterator TypedArray<ElementType, Allocator>::end() {
+    return buffer + finish;
+}
+
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::const_iterator TypedArray<ElementType, Allocator>::begin() const {
+    return buffer + origin;
+}
+
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::const_iterator TypedArray<ElementType, Allocator>::end() const {
+    return buffer + finish;
+}
+
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::const_iterator TypedArray<ElementType, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename ElementType, typename Allocator>
+typename TypedArray<ElementType, Allocator>::const_iterator TypedArray<ElementType, Allocator>::cend() const {
+    return end();
 }
 
 // Setters
-template <typename ElementType>
-void TypedArray<ElementType>::set(int index, ElementType value) {
+template <typename ElementType, typename Allocator>
+void TypedArray<ElementType, Allocator>::set(int index, ElementType value) {
     if (index < 0) {
         throw std::range_error("Negative index in array");
     }
     while ( out_of_buffer(index_to_offset(index) ) ) {
         extend_buffer();
     }
-    buffer[index_to_offset(index)] = value;
-    if ( index >= size() ) {
-        end = index_to_offset(index+1);
+    int offset = index_to_offset(index);
+    if ( offset < finish ) {
+        buffer[offset] = std::move(value);
+        return;
+    }
+    // Elements skipped over between the old end and index are default constructed
+    for ( ; finish < offset; finish++ ) {
+        traits::construct(allocator, buffer + finish);
+    }
+    traits::construct(allocator, buffer + finish, std::move(value));
+    finish++;
+}
+
+template <typename ElementType, typename Allocator>
+template <typename... Args>
+ElementType &TypedArray<ElementType, Allocator>::emplace_back(Args&&... args) {
+    if ( out_of_buffer(finish) ) {
+        // The arguments may refer to elements of this array, which extending
+        // the buffer frees, so the element is made before that
+        ElementType value(std::forward<Args>(args)...);
+        while ( out_of_buffer(finish) ) {
+            extend_buffer();
+        }
+        traits::construct(allocator, buffer + finish, std::move(value));
+        return buffer[finish++];
+    }
+    traits::construct(allocator, buffer + finish, std::forward<Args>(args)...);
+    return buffer[finish++];
+}
+
+template <typename ElementType, typename Allocator>
+template <typename... Args>
+ElementType &TypedArray<ElementType, Allocator>::emplace_front(Args&&... args) {
+    if ( out_of_buffer(origin - 1) ) {
+        // As in emplace_back
+        ElementType value(std::forward<Args>(args)...);
+        while ( out_of_buffer(origin - 1) ) {
+            extend_buffer();
+        }
+        traits::construct(allocator, buffer + origin - 1, std::move(value));
+        return buffer[--origin];
     }
+    traits::construct(allocator, buffer + origin - 1, std::forward<Args>(args)...);
+    return buffer[--origin];
 }
 
-template <typename ElementType>
-std::ostream &operator<<(std::ostream &os, TypedArray<ElementType> &array)
+template <typename ElementType, typename Allocator>
+std::ostream &operator<<(std::ostream &os, const TypedArray<ElementType, Allocator> &array)
 {
     os << '[';
     for (int i=0; i<array.size(); i++ ) {
-        os << array.get(i);
+        os << array[i];
         if ( i < array.size() - 1 ) {
             os << ",";
         }
@@ -138,46 +334,91 @@ std::ostream &operator<<(std::ostream &os, TypedArray<ElementType> &array)
 
 // Private methods
 
-template <typename ElementType>
-int TypedArray<ElementType>::index_to_offset ( int index ) const {
+template <typename ElementType, typename Allocator>
+int TypedArray<ElementType, Allocator>::index_to_offset ( int index ) const {
     return index + origin;
 }
 
 /* Position of the element at buffer position 'offset' */
-template <typename ElementType>
-int TypedArray<ElementType>::offset_to_index ( int offset ) const  {
+template <typename ElementType, typename Allocator>
+int TypedArray<ElementType, Allocator>::offset_to_index ( int offset ) const  {
     return offset - origin;
 }
 
 /* Non-zero if and only if offset lies ouside the buffer */
-template <typename ElementType>
-bool TypedArray<ElementType>::out_of_buffer ( int offset ) const {
+template <typename ElementType, typename Allocator>
+bool TypedArray<ElementType, Allocator>::out_of_buffer ( int offset ) const {
     return offset < 0 || offset >= capacity;
 }
 
-/* Makes a new buffer that is twice the size of the old buffer,
-   copies the old information into the new buffer, and deletes
-   the old buffer */
-template <typename ElementType>
-void TypedArray<ElementType>::extend_buffer() {
+/* Destroys the elements and gives the buffer back to the allocator */
+template <typename ElementType, typename Allocator>
+void TypedArray<ElementType, Allocator>::release() {
+    if ( buffer == nullptr ) {
+        return;
+    }
+    for ( int i=origin; i<finish; i++ ) {
+        traits::destroy(allocator, buffer + i);
+    }
+    traits::deallocate(allocator, buffer, capacity);
+    buffer = nullptr;
+}
 
-    auto temp = new ElementType[2 * capacity]();
-    int new_origin = capacity - (end - origin)/2,
-           new_end = new_origin + (end - origin);
+/* Moves the elements to consecutive positions starting at 'to'. Trivially
+   copyable types are copied as bytes, and need no destruction. */
+template <typename ElementType, typename Allocator>
+void TypedArray<ElementType, Allocator>::relocate(ElementType * to, std::true_type) {
+    memcpy(static_cast<void *>(to), buffer + origin, size() * sizeof(ElementType));
+}
 
-    for ( int i=0; i<size(); i++ ) {
-        temp[new_origin+i] = get(i);
+/* Other types are moved if that cannot throw, and copied otherwise, so
+   that an exception leaves the array as it was */
+template <typename ElementType, typename Allocator>
+void TypedArray<ElementType, Allocator>::relocate(ElementType * to, std::false_type) {
+    int i = origin;
+    try {
+        for ( ; i<finish; i++ ) {
+            traits::construct(allocator, to + i - origin, std::move_if_noexcept(buffer[i]));
+        }
+    } catch (...) {
+        while ( i-- > origin ) {
+            traits::destroy(allocator, to + i - origin);
+        }
+        throw;
+    }
+    for ( i=origin; i<finish; i++ ) {
+        traits::destroy(allocator, buffer + i);
     }
+}
 
-    delete[] buffer;
-    buffer = temp;
+/* Makes a new buffer that is twice the size of the old buffer,
+   moves the old elements into the middle of the new buffer, and
+   deletes the old buffer. Only the elements are constructed. */
+template <typename ElementType, typename Allocator>
+void TypedArray<ElementType, Allocator>::extend_buffer() {
+
+    int new_capacity = capacity > 0 ? 2 * capacity : INITIAL_CAPACITY,
+        new_origin = ( new_capacity - size() ) / 2,
+        new_finish = new_origin + size();
+
+    ElementType * temp = traits::allocate(allocator, new_capacity);
+    try {
+        relocate(temp + new_origin, std::is_trivially_copyable<ElementType>());
+    } catch (...) {
+        traits::deallocate(allocator, temp, new_capacity);
+        throw;
+    }
+    if ( buffer != nullptr ) {
+        traits::deallocate(allocator, buffer, capacity);
+    }
 
-    capacity = 2 * capacity;
+    buffer = temp;
+    capacity = new_capacity;
     origin = new_origin;
-    end = new_end;
+    finish = new_finish;
 
     return;
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,141 @@
+#ifndef TYPED_ARRAY_PARALLEL
+#define TYPED_ARRAY_PARALLEL
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "typed_array.h"
+
+// Multithreaded sort, transform and reduce over a TypedArray. Each splits the
+// array into one contiguous chunk per thread. threads defaults to the number
+// of hardware threads, and arrays too small to be worth splitting are done
+// on the calling thread. An exception thrown on any thread is rethrown by
+// the call, once all the threads have finished.
+
+// Chunks are never smaller than this many elements
+const int PARALLEL_MIN_CHUNK = 1 << 14;
+
+// The number of chunks to split n elements into
+inline int parallel_chunks(int n, int threads) {
+    if ( threads <= 0 ) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max(1, std::min(threads, n / PARALLEL_MIN_CHUNK));
+}
+
+// Start of chunk t of n elements split into chunks chunks
+inline int parallel_chunk_start(int n, int chunks, int t) {
+    return (long long) n * t / chunks;
+}
+
+// Calls f(0), ..., f(tasks - 1) each on its own thread, the last on the
+// calling thread, and waits for them all to return
+template <typename F>
+void parallel_tasks(int tasks, F f) {
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(tasks);
+    for ( int t=0; t<tasks; t++ ) {
+        auto run = [&f, &errors, t]() {
+            try {
+                f(t);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        };
+        if ( t < tasks - 1 ) {
+            workers.push_back(std::thread(run));
+        } else {
+            run();
+        }
+    }
+    for ( auto& w : workers ) {
+        w.join();
+    }
+    for ( auto& e : errors ) {
+        if ( e ) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+// Sorts the chunks in parallel, then merges neighbouring runs in rounds,
+// halving the number of runs (and of threads busy) each round
+template <typename ElementType, typename Allocator, typename Compare = std::less<ElementType>>
+void parallel_sort(TypedArray<ElementType, Allocator>& array, Compare compare = Compare(), int threads = 0) {
+
+    int n = array.size(),
+        chunks = parallel_chunks(n, threads);
+    ElementType * x = array.data();
+
+    std::vector<int> bounds;
+    for ( int t=0; t<=chunks; t++ ) {
+        bounds.push_back(parallel_chunk_start(n, chunks, t));
+    }
+
+    parallel_tasks(chunks, [&](int t) {
+        std::sort(x + bounds[t], x + bounds[t+1], compare);
+    });
+
+    while ( bounds.size() > 2 ) {
+        parallel_tasks((bounds.size() - 1) / 2, [&](int p) {
+            std::inplace_merge(x + bounds[2*p], x + bounds[2*p+1], x + bounds[2*p+2], compare);
+        });
+        std::vector<int> merged;
+        for ( int i=0; i<(int) bounds.size(); i+=2 ) {
+            merged.push_back(bounds[i]);
+        }
+        if ( merged.back() != n ) {
+            merged.push_back(n);
+        }
+        bounds = merged;
+    }
+
+}
+
+// out[i] = op(in[i]). out must be at least as long as in, and may be in.
+template <typename T, typename A, typename U, typename B, typename Op>
+void parallel_transform(const TypedArray<T, A>& in, TypedArray<U, B>& out, Op op, int threads = 0) {
+    if ( out.size() < in.size() ) {
+        throw std::range_error("Output array too small for transform");
+    }
+    int n = in.size(),
+        chunks = parallel_chunks(n, threads);
+    const T * x = in.data();
+    U * y = out.data();
+    parallel_tasks(chunks, [&](int t) {
+        int begin = parallel_chunk_start(n, chunks, t),
+            end = parallel_chunk_start(n, chunks, t + 1);
+        std::transform(x + begin, x + end, y + begin, op);
+    });
+}
+
+// Combines init and the elements with op, which must be associative. The
+// chunks' results are combined in order, so op need not be commutative.
+template <typename ElementType, typename Allocator, typename T, typename Op = std::plus<T>>
+T parallel_reduce(const TypedArray<ElementType, Allocator>& array, T init, Op op = Op(), int threads = 0) {
+    int n = array.size(),
+        chunks = parallel_chunks(n, threads);
+    if ( n == 0 ) {
+        return init;
+    }
+    const ElementType * x = array.data();
+    std::vector<T> partials(chunks);
+    parallel_tasks(chunks, [&](int t) {
+        int begin = parallel_chunk_start(n, chunks, t),
+            end = parallel_chunk_start(n, chunks, t + 1);
+        T result = x[begin];
+        for ( int i=begin+1; i<end; i++ ) {
+            result = op(result, x[i]);
+        }
+        partials[t] = result;
+    });
+    for ( auto& p : partials ) {
+        init = op(init, p);
+    }
+    return init;
+}
+
+#endif
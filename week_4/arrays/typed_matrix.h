@@ -0,0 +1,375 @@
+#ifndef TYPED_MATRIX
+#define TYPED_MATRIX
+
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include "typed_array.h"
+
+// A rows x cols matrix stored row-major in one contiguous TypedArray, so
+// element (i,j) is at data()[i * cols + j]. Unlike a TypedArray of
+// TypedArrays there is one allocation and no per-row bookkeeping, and rows
+// follow each other in memory.
+//
+// The elementwise operations and reductions are written as plain loops over
+// restrict-qualified pointers, which the compiler vectorizes when optimizing
+// (e.g. -O3 -march=native). transpose and multiply work on cache-sized blocks.
+template <typename ElementType, typename Allocator = std::allocator<ElementType>>
+class TypedMatrix {
+
+public:
+
+    // Side of the square blocks used by transpose and multiply
+    static const int BLOCK = 32;
+
+    TypedMatrix(int rows, int cols, const ElementType& value = ElementType(),
+                const Allocator& allocator = Allocator());
+
+    static TypedMatrix identity(int n);
+
+    // Getters
+    int rows() const;
+    int cols() const;
+    int size() const;
+    ElementType &operator()(int i, int j);
+    const ElementType &operator()(int i, int j) const;
+    ElementType &safe_get(int i, int j);
+    ElementType * data();
+    const ElementType * data() const;
+
+    // Elementwise operations. Shapes must match.
+    TypedMatrix operator+(const TypedMatrix& other) const;
+    TypedMatrix operator-(const TypedMatrix& other) const;
+    TypedMatrix operator*(const ElementType& a) const;
+    TypedMatrix hadamard(const TypedMatrix& other) const;
+    TypedMatrix& operator+=(const TypedMatrix& other);
+    TypedMatrix& operator-=(const TypedMatrix& other);
+    TypedMatrix& operator*=(const ElementType& a);
+
+    // Matrix operations
+    TypedMatrix operator*(const TypedMatrix& other) const;
+    TypedMatrix transpose() const;
+
+    // Reductions, over all elements or along an axis: axis 0 reduces each
+    // column to give a 1 x cols matrix, axis 1 each row to give rows x 1
+    ElementType sum() const;
+    TypedMatrix sum(int axis) const;
+    TypedMatrix min(int axis) const;
+    TypedMatrix max(int axis) const;
+
+    bool operator==(const TypedMatrix& other) const;
+    bool operator!=(const TypedMatrix& other) const;
+
+private:
+
+    int _rows, _cols;
+    TypedArray<ElementType, Allocator> _elements;
+
+    void check_same_shape(const TypedMatrix& other) const;
+    void check_axis(int axis) const;
+
+    template <typename Op>
+    TypedMatrix elementwise(const TypedMatrix& other, Op op) const;
+
+    template <typename Op>
+    TypedMatrix reduce(int axis, Op op) const;
+
+};
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator>::TypedMatrix(int rows, int cols, const ElementType& value,
+                                                 const Allocator& allocator)
+  : _rows(rows), _cols(cols), _elements(rows * cols, value, allocator) {
+    if ( rows < 0 || cols < 0 ) {
+        throw std::range_error("Negative matrix dimension");
+    }
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::identity(int n) {
+    TypedMatrix m(n, n);
+    for ( int i=0; i<n; i++ ) {
+        m(i, i) = ElementType(1);
+    }
+    return m;
+}
+
+// Getters
+template <typename ElementType, typename Allocator>
+int TypedMatrix<ElementType, Allocator>::rows() const {
+    return _rows;
+}
+
+template <typename ElementType, typename Allocator>
+int TypedMatrix<ElementType, Allocator>::cols() const {
+    return _cols;
+}
+
+template <typename ElementType, typename Allocator>
+int TypedMatrix<ElementType, Allocator>::size() const {
+    return _rows * _cols;
+}
+
+// Unchecked access, for inner loops
+template <typename ElementType, typename Allocator>
+ElementType &TypedMatrix<ElementType, Allocator>::operator()(int i, int j) {
+    return _elements.data()[i * _cols + j];
+}
+
+template <typename ElementType, typename Allocator>
+const ElementType &TypedMatrix<ElementType, Allocator>::operator()(int i, int j) const {
+    return _elements.data()[i * _cols + j];
+}
+
+template <typename ElementType, typename Allocator>
+ElementType &TypedMatrix<ElementType, Allocator>::safe_get(int i, int j) {
+    if ( i < 0 || i >= _rows || j < 0 || j >= _cols ) {
+        throw std::range_error("Out of range index in matrix");
+    }
+    return (*this)(i, j);
+}
+
+template <typename ElementType, typename Allocator>
+ElementType * TypedMatrix<ElementType, Allocator>::data() {
+    return _elements.data();
+}
+
+template <typename ElementType, typename Allocator>
+const ElementType * TypedMatrix<ElementType, Allocator>::data() const {
+    return _elements.data();
+}
+
+// Elementwise operations
+template <typename ElementType, typename Allocator>
+template <typename Op>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::elementwise(const TypedMatrix& other, Op op) const {
+    check_same_shape(other);
+    TypedMatrix result(_rows, _cols, ElementType(), _elements.get_allocator());
+    const ElementType * __restrict x = data();
+    const ElementType * __restrict y = other.data();
+    ElementType * __restrict z = result.data();
+    for ( int k=0; k<size(); k++ ) {
+        z[k] = op(x[k], y[k]);
+    }
+    return result;
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::operator+(const TypedMatrix& other) const {
+    return elementwise(other, [](const ElementType& x, const ElementType& y) { return x + y; });
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::operator-(const TypedMatrix& other) const {
+    return elementwise(other, [](const ElementType& x, const ElementType& y) { return x - y; });
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::hadamard(const TypedMatrix& other) const {
+    return elementwise(other, [](const ElementType& x, const ElementType& y) { return x * y; });
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::operator*(const ElementType& a) const {
+    TypedMatrix result(*this);
+    return result *= a;
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator>& TypedMatrix<ElementType, Allocator>::operator+=(const TypedMatrix& other) {
+    check_same_shape(other);
+    // Not __restrict: other may be this matrix, as in m += m
+    ElementType * x = data();
+    const ElementType * y = other.data();
+    for ( int k=0; k<size(); k++ ) {
+        x[k] += y[k];
+    }
+    return *this;
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator>& TypedMatrix<ElementType, Allocator>::operator-=(const TypedMatrix& other) {
+    check_same_shape(other);
+    // Not __restrict: other may be this matrix, as in m -= m
+    ElementType * x = data();
+    const ElementType * y = other.data();
+    for ( int k=0; k<size(); k++ ) {
+        x[k] -= y[k];
+    }
+    return *this;
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator>& TypedMatrix<ElementType, Allocator>::operator*=(const ElementType& a) {
+    ElementType * __restrict x = data();
+    for ( int k=0; k<size(); k++ ) {
+        x[k] *= a;
+    }
+    return *this;
+}
+
+// Matrix operations
+
+// Blocked i-k-j product: for each block the innermost loop runs along a row
+// of other and of the result, both contiguous, so it vectorizes, and the
+// blocks of the three matrices stay in cache while they are reused.
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::operator*(const TypedMatrix& other) const {
+    if ( _cols != other._rows ) {
+        throw std::invalid_argument("Matrix dimensions do not match for multiplication");
+    }
+    int n = _rows, m = _cols, p = other._cols;
+    TypedMatrix result(n, p, ElementType(), _elements.get_allocator());
+    const ElementType * __restrict a = data();
+    const ElementType * __restrict b = other.data();
+    ElementType * __restrict c = result.data();
+    for ( int i0=0; i0<n; i0+=BLOCK ) {
+        for ( int k0=0; k0<m; k0+=BLOCK ) {
+            for ( int j0=0; j0<p; j0+=BLOCK ) {
+                int i1 = std::min(i0 + BLOCK, n),
+                    k1 = std::min(k0 + BLOCK, m),
+                    j1 = std::min(j0 + BLOCK, p);
+                for ( int i=i0; i<i1; i++ ) {
+                    for ( int k=k0; k<k1; k++ ) {
+                        const ElementType aik = a[i * m + k];
+                        for ( int j=j0; j<j1; j++ ) {
+                            c[i * p + j] += aik * b[k * p + j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Blocked, so that both the rows read and the columns written stay in cache
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::transpose() const {
+    TypedMatrix result(_cols, _rows, ElementType(), _elements.get_allocator());
+    const ElementType * __restrict a = data();
+    ElementType * __restrict t = result.data();
+    for ( int i0=0; i0<_rows; i0+=BLOCK ) {
+        for ( int j0=0; j0<_cols; j0+=BLOCK ) {
+            int i1 = std::min(i0 + BLOCK, _rows),
+                j1 = std::min(j0 + BLOCK, _cols);
+            for ( int i=i0; i<i1; i++ ) {
+                for ( int j=j0; j<j1; j++ ) {
+                    t[j * _rows + i] = a[i * _cols + j];
+                }
+            }
+        }
+    }
+    return result;
+}
+
+// Reductions
+template <typename ElementType, typename Allocator>
+ElementType TypedMatrix<ElementType, Allocator>::sum() const {
+    const ElementType * __restrict x = data();
+    ElementType result = ElementType();
+    for ( int k=0; k<size(); k++ ) {
+        result += x[k];
+    }
+    return result;
+}
+
+// Reduces along an axis with op, starting from the first row or column. Along
+// axis 0 whole rows are combined at once, so the inner loop is contiguous.
+template <typename ElementType, typename Allocator>
+template <typename Op>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::reduce(int axis, Op op) const {
+    check_axis(axis);
+    if ( _rows == 0 || _cols == 0 ) {
+        throw std::range_error("Cannot reduce an empty matrix");
+    }
+    const ElementType * __restrict x = data();
+    if ( axis == 0 ) {
+        TypedMatrix result(1, _cols, ElementType(), _elements.get_allocator());
+        ElementType * __restrict r = result.data();
+        for ( int j=0; j<_cols; j++ ) {
+            r[j] = x[j];
+        }
+        for ( int i=1; i<_rows; i++ ) {
+            for ( int j=0; j<_cols; j++ ) {
+                r[j] = op(r[j], x[i * _cols + j]);
+            }
+        }
+        return result;
+    } else {
+        TypedMatrix result(_rows, 1, ElementType(), _elements.get_allocator());
+        for ( int i=0; i<_rows; i++ ) {
+            ElementType r = x[i * _cols];
+            for ( int j=1; j<_cols; j++ ) {
+                r = op(r, x[i * _cols + j]);
+            }
+            result(i, 0) = r;
+        }
+        return result;
+    }
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::sum(int axis) const {
+    return reduce(axis, [](const ElementType& x, const ElementType& y) { return x + y; });
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::min(int axis) const {
+    return reduce(axis, [](const ElementType& x, const ElementType& y) { return y < x ? y : x; });
+}
+
+template <typename ElementType, typename Allocator>
+TypedMatrix<ElementType, Allocator> TypedMatrix<ElementType, Allocator>::max(int axis) const {
+    return reduce(axis, [](const ElementType& x, const ElementType& y) { return x < y ? y : x; });
+}
+
+template <typename ElementType, typename Allocator>
+bool TypedMatrix<ElementType, Allocator>::operator==(const TypedMatrix& other) const {
+    return _rows == other._rows && _cols == other._cols &&
+           std::equal(data(), data() + size(), other.data());
+}
+
+template <typename ElementType, typename Allocator>
+bool TypedMatrix<ElementType, Allocator>::operator!=(const TypedMatrix& other) const {
+    return !(*this == other);
+}
+
+template <typename ElementType, typename Allocator>
+std::ostream &operator<<(std::ostream &os, const TypedMatrix<ElementType, Allocator> &m)
+{
+    os << '[';
+    for ( int i=0; i<m.rows(); i++ ) {
+        os << '[';
+        for ( int j=0; j<m.cols(); j++ ) {
+            os << m(i, j);
+            if ( j < m.cols() - 1 ) {
+                os << ",";
+            }
+        }
+        os << ']';
+        if ( i < m.rows() - 1 ) {
+            os << ",";
+        }
+    }
+    os << ']';
+    return os;
+}
+
+// Private methods
+
+template <typename ElementType, typename Allocator>
+void TypedMatrix<ElementType, Allocator>::check_same_shape(const TypedMatrix& other) const {
+    if ( _rows != other._rows || _cols != other._cols ) {
+        throw std::invalid_argument("Matrix dimensions do not match");
+    }
+}
+
+template <typename ElementType, typename Allocator>
+void TypedMatrix<ElementType, Allocator>::check_axis(int axis) const {
+    if ( axis != 0 && axis != 1 ) {
+        throw std::range_error("Matrix axis must be 0 or 1");
+    }
+}
+
+#endif
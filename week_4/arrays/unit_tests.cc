@@ -3,7 +3,12 @@
 #include <assert.h>
 #include "double_array.h"
 #include "typed_array.h"
+#include "typed_matrix.h"
+#include "typed_array_parallel.h"
 #include "gtest/gtest.h"
+#include <string>
+#include <algorithm>
+#include <numeric>
 
 namespace {
 
@@ -159,6 +164,31 @@ namespace {
         }
     }
 
+    TEST(DoubleArray, Expressions) {
+        DoubleArray a(1, 5, 1), b(0, 8, 2);   // [1,2,3,4,5], [0,2,4,6,8]
+        ASSERT_EQ(5, a.size());
+        DoubleArray c = a + 2 * b - b / 2;
+        ASSERT_EQ(5, c.size());
+        for ( int i=0; i<5; i++ ) {
+            ASSERT_EQ(a.get(i) + 1.5 * b.get(i), c.get(i));
+        }
+        c = -(a * a);
+        ASSERT_EQ(-25, c.get(4));
+        a = a * b + 1;  // in place, reading a as it is written
+        ASSERT_EQ(41, a.get(4));
+        a += b;
+        a -= 0.5 * b;
+        a *= 2;
+        ASSERT_EQ(90, a.get(4));
+        DoubleArray d;
+        d = b * 3;      // resizes d
+        ASSERT_EQ(5, d.size());
+        ASSERT_EQ(24, d.get(4));
+        DoubleArray e(0, 1, 0.5);
+        ASSERT_THROW(d = a + e, std::invalid_argument);
+        ASSERT_THROW(DoubleArray(0, 1, 0), std::invalid_argument);
+    }
+
     TEST(TypedArray, Construction) {
         TypedArray<Point> b;
         b.set(0, Point(1,2,3));
@@ -200,4 +230,237 @@ namespace {
 
     }
 
+    // Counts the ways it is constructed, to check that growing never copies
+    struct Tracked {
+        static int copies, moves, live;
+        int value;
+        Tracked(int value = 0) : value(value) { live++; }
+        Tracked(const Tracked& other) : value(other.value) { copies++; live++; }
+        Tracked(Tracked&& other) noexcept : value(other.value) { moves++; live++; }
+        Tracked& operator=(const Tracked& other) { value = other.value; copies++; return *this; }
+        Tracked& operator=(Tracked&& other) noexcept { value = other.value; moves++; return *this; }
+        ~Tracked() { live--; }
+    };
+    int Tracked::copies = 0, Tracked::moves = 0, Tracked::live = 0;
+
+    // An allocator that counts how many buffers it has handed out
+    template <typename T>
+    struct CountingAllocator {
+        typedef T value_type;
+        int * allocations;
+        CountingAllocator(int * allocations) : allocations(allocations) {}
+        template <typename U> CountingAllocator(const CountingAllocator<U>& other) : allocations(other.allocations) {}
+        T * allocate(std::size_t n) { (*allocations)++; return static_cast<T *>(::operator new(n * sizeof(T))); }
+        void deallocate(T * p, std::size_t) { ::operator delete(p); }
+        bool operator==(const CountingAllocator& other) const { return allocations == other.allocations; }
+        bool operator!=(const CountingAllocator& other) const { return allocations != other.allocations; }
+    };
+
+    TEST(TypedArray, Emplace) {
+        TypedArray<std::string> a;
+        for ( int i=0; i<100; i++ ) {
+            a.emplace_back(3, 'a' + i % 26);
+            a.emplace_front("front");
+        }
+        ASSERT_EQ(200, a.size());
+        ASSERT_EQ("front", a.get(0));
+        ASSERT_EQ("aaa", a.get(100));
+        ASSERT_EQ("ddd", a.get(103));
+        a.set(250, "far");
+        ASSERT_EQ(251, a.size());
+        ASSERT_EQ("", a.get(249));
+        ASSERT_EQ("far", a.get(250));
+        TypedArray<std::string> full(1, "x"); // no free slot at either end
+        full.emplace_front("y");
+        full.emplace_back("z");
+        ASSERT_EQ(3, full.size());
+        ASSERT_EQ("y", full.get(0));
+        ASSERT_EQ("x", full.get(1));
+        ASSERT_EQ("z", full.get(2));
+    }
+
+    TEST(TypedArray, EmplaceSelf) {
+        // Arguments referring to the array's own elements survive growth
+        TypedArray<double> a;
+        TypedArray<std::string> b;
+        a.emplace_back(1.5);
+        b.emplace_back("first");
+        for ( int i=0; i<100; i++ ) {
+            a.emplace_back(a.get(0));
+            a.emplace_front(a.get(a.size() - 1));
+            b.emplace_back(b.get(0));
+            b.emplace_front(b.get(b.size() - 1));
+        }
+        ASSERT_EQ(201, a.size());
+        for ( int i=0; i<a.size(); i++ ) {
+            ASSERT_EQ(1.5, a.get(i));
+            ASSERT_EQ("first", b.get(i));
+        }
+    }
+
+    TEST(TypedArray, Move) {
+        Tracked::copies = Tracked::moves = 0;
+        {
+            TypedArray<Tracked> a;
+            for ( int i=0; i<1000; i++ ) {
+                a.emplace_back(i);
+            }
+            ASSERT_EQ(0, Tracked::copies); // growth moves
+            int moves = Tracked::moves;
+            TypedArray<Tracked> b(std::move(a));
+            ASSERT_EQ(moves, Tracked::moves); // moving the array moves no elements
+            ASSERT_EQ(0, a.size());
+            ASSERT_EQ(999, b.get(999).value);
+            TypedArray<Tracked> c;
+            c = std::move(b);
+            ASSERT_EQ(1000, c.size());
+            ASSERT_EQ(0, Tracked::copies);
+            a.emplace_back(7); // moved-from arrays can be reused
+            ASSERT_EQ(7, a.get(0).value);
+            TypedArray<Tracked> d(c);
+            ASSERT_EQ(1000, Tracked::copies);
+            ASSERT_EQ(2001, Tracked::live);
+        }
+        ASSERT_EQ(0, Tracked::live);
+    }
+
+    TEST(TypedArray, NestedGrowth) {
+        TypedArray<TypedArray<double>> m;
+        for ( int i=0; i<100; i++ ) {
+            m.emplace_back().set(i, i);
+        }
+        ASSERT_EQ(100, m.size());
+        ASSERT_EQ(99, m.get(99).get(99));
+        ASSERT_EQ(100, m.get(99).size());
+    }
+
+    TEST(TypedArray, Allocator) {
+        int allocations = 0;
+        CountingAllocator<double> allocator(&allocations);
+        TypedArray<double, CountingAllocator<double>> a(allocator);
+        ASSERT_EQ(1, allocations);
+        for ( int i=0; i<80; i++ ) {
+            a.emplace_back(i);
+        }
+        ASSERT_EQ(5, allocations); // 10, 20, 40, 80, 160
+        TypedArray<double, CountingAllocator<double>> b(a);
+        ASSERT_EQ(6, allocations); // one buffer the size of a's
+        ASSERT_EQ(79, b.get(79));
+        ASSERT_TRUE(b.get_allocator() == allocator);
+    }
+
+    TEST(TypedArray, Iterators) {
+        TypedArray<int> a;
+        for ( int i=0; i<20; i++ ) {
+            a.emplace_front(i);
+        }
+        ASSERT_EQ(20, a.end() - a.begin());
+        ASSERT_EQ(a.data(), a.begin());
+        std::sort(a.begin(), a.end());
+        ASSERT_EQ(7, a[7]);
+        ASSERT_EQ(190, std::accumulate(a.cbegin(), a.cend(), 0));
+        int n = 0;
+        for ( int &x : a ) {
+            x *= 2;
+            n++;
+        }
+        ASSERT_EQ(20, n);
+        const TypedArray<int> &b = a;
+        ASSERT_EQ(38, *std::max_element(b.begin(), b.end()));
+        ASSERT_EQ(20, b.size()); // operator[] never grows the array
+    }
+
+    TEST(TypedArray, Parallel) {
+        int n = 200001;
+        TypedArray<double> a(n, 0.0), b(n, 0.0);
+        for ( int i=0; i<n; i++ ) {
+            a[i] = (i * 7919) % n;
+        }
+        parallel_sort(a, std::less<double>(), 5);
+        ASSERT_TRUE(std::is_sorted(a.begin(), a.end()));
+        ASSERT_EQ(0, a[0]);
+        ASSERT_EQ(n - 1, a[n - 1]);
+        parallel_transform(a, b, [](double x) { return 2 * x; }, 4);
+        ASSERT_EQ(2.0 * (n - 1), b[n - 1]);
+        ASSERT_EQ((double) n * (n - 1), parallel_reduce(b, 0.0, std::plus<double>(), 3));
+        ASSERT_EQ(n - 1, parallel_reduce(a, -1.0, [](double x, double y) { return std::max(x, y); }));
+        parallel_sort(b, std::greater<double>());
+        ASSERT_EQ(0, b[n - 1]);
+        TypedArray<double> c(5, 0.0);
+        ASSERT_THROW(parallel_transform(a, c, [](double x) { return x; }), std::range_error);
+    }
+
+    TEST(TypedMatrix, Operations) {
+        TypedMatrix<double> a(2, 3), b(3, 2);
+        for ( int i=0; i<2; i++ ) {
+            for ( int j=0; j<3; j++ ) {
+                a(i, j) = i * 3 + j;     // [[0,1,2],[3,4,5]]
+                b(j, i) = i + j;         // [[0,1],[1,2],[2,3]]
+            }
+        }
+        ASSERT_EQ(a.data() + 4, &a(1, 1));
+        ASSERT_THROW(a.safe_get(2, 0), std::range_error);
+
+        TypedMatrix<double> c = a * b;
+        ASSERT_EQ(2, c.rows());
+        ASSERT_EQ(2, c.cols());
+        ASSERT_EQ(5, c(0, 0));
+        ASSERT_EQ(8, c(0, 1));
+        ASSERT_EQ(14, c(1, 0));
+        ASSERT_EQ(26, c(1, 1));
+        ASSERT_EQ(a, a * TypedMatrix<double>::identity(3));
+        ASSERT_THROW(a * a, std::invalid_argument);
+
+        TypedMatrix<double> t = a.transpose();
+        ASSERT_EQ(3, t.rows());
+        ASSERT_EQ(5, t(2, 1));
+        ASSERT_EQ(b, (t + b - t) * 1.0);
+        t -= t;
+        ASSERT_EQ(TypedMatrix<double>(3, 2), t);
+        ASSERT_EQ(15, a.sum());
+        ASSERT_EQ(3, a.sum(0)(0, 0));
+        ASSERT_EQ(12, a.sum(1)(1, 0));
+        ASSERT_EQ(3, a.min(1)(1, 0));
+        ASSERT_EQ(2, a.max(1)(0, 0));
+        ASSERT_EQ(25, a.hadamard(a)(1, 2));
+        ASSERT_THROW(a + b, std::invalid_argument);
+    }
+
+    TEST(TypedMatrix, Allocator) {
+        // Results use the allocator of the matrix they come from
+        int allocations = 0;
+        CountingAllocator<double> allocator(&allocations);
+        TypedMatrix<double, CountingAllocator<double>> a(2, 3, 1.0, allocator);
+        a += a;
+        ASSERT_EQ(2, a(1, 2));
+        int before = allocations;
+        auto t = a.transpose();
+        auto p = a * t;
+        auto s = a + a;
+        auto r = a.sum(0);
+        ASSERT_EQ(before + 4, allocations);
+        ASSERT_EQ(12, p(1, 0));
+        ASSERT_EQ(4, s(0, 2));
+        ASSERT_EQ(4, r(0, 1));
+    }
+
+    TEST(TypedMatrix, Blocks) {
+        // Bigger than a block in every direction, with ragged edges
+        int n = 70, m = 45, p = 33;
+        TypedMatrix<int> a(n, m), b(m, p);
+        for ( int i=0; i<n; i++ ) for ( int k=0; k<m; k++ ) a(i, k) = (i + 2 * k) % 7;
+        for ( int k=0; k<m; k++ ) for ( int j=0; j<p; j++ ) b(k, j) = (3 * k + j) % 5;
+        TypedMatrix<int> c = a * b, t = a.transpose();
+        for ( int i=0; i<n; i++ ) {
+            for ( int j=0; j<p; j++ ) {
+                int expected = 0;
+                for ( int k=0; k<m; k++ ) expected += a(i, k) * b(k, j);
+                ASSERT_EQ(expected, c(i, j));
+            }
+            for ( int k=0; k<m; k++ ) {
+                ASSERT_EQ(a(i, k), t(k, i));
+            }
+        }
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef _BATCH_CHANNEL_H
+#define _BATCH_CHANNEL_H
+
+#include <string>
+#include <vector>
+
+#include "elma.h"
+
+namespace elma {
+
+    using std::string;
+    using std::vector;
+
+    //! The untyped part of a BatchChannel, through which the Manager keeps track of it
+    class BatchChannelBase {
+
+        public:
+
+        //! Constructor
+        //! \param name The name of the channel
+        //! \param size The number of instances, and so of values, the channel carries
+        BatchChannelBase(string name, int size) : _name(name), _size(size), _nonempty(false) {}
+        virtual ~BatchChannelBase() = default;
+
+        //! Getter
+        //! \return The name of the channel
+        inline string name() const { return _name; }
+
+        //! Getter
+        //! \return The number of values in the column
+        inline int size() const { return _size; }
+
+        //! Getter
+        //! \return True if anything has been sent on the channel
+        inline bool nonempty() const { return _nonempty; }
+
+        //! Getter
+        //! \return True if nothing has been sent on the channel
+        inline bool empty() const { return !_nonempty; }
+
+        protected:
+
+        string _name;
+        int _size;
+        bool _nonempty;
+
+    };
+
+    //! A columnar channel: one value for each instance of a BatchProcess.
+
+    //! Where a Channel holds a queue of json values, a BatchChannel holds a
+    //! single column of T, the latest value sent for each instance, so a whole
+    //! population of instances can communicate with one contiguous array. Values
+    //! can be sent and read one instance at a time, or as a whole column.
+    //! \include examples/batch_feedback.cc
+    template <typename T>
+    class BatchChannel : public BatchChannelBase {
+
+        public:
+
+        //! Constructor
+        //! \param name The name of the channel
+        //! \param size The number of instances
+        //! \param initial The value of every instance until one is sent
+        BatchChannel(string name, int size, T initial = T()) 
+          : BatchChannelBase(name, size), _column(size, initial) {}
+
+        //! Send a value for one instance
+        //! \param i The instance
+        //! \param value The value
+        //! \return A reference to the channel, for chaining
+        BatchChannel& send(int i, T value) {
+            _column.at(i) = value;
+            _nonempty = true;
+            return *this;
+        }
+
+        //! Send a value for every instance
+        //! \param values A column of size() values
+        //! \return A reference to the channel, for chaining
+        BatchChannel& send(const vector<T>& values) {
+            if ( (int) values.size() != size() ) {
+                throw Exception("Sent a column of the wrong size to batch channel " + name());
+            }
+            _column = values;
+            _nonempty = true;
+            return *this;
+        }
+
+        //! Writable access to the whole column, to fill it in place with no copy.
+        //! Counts as a send.
+        //! \return The column
+        vector<T>& column() {
+            _nonempty = true;
+            return _column;
+        }
+
+        //! Get the latest value for one instance.
+        //! Throws an error if the channel is empty.
+        //! \param i The instance
+        //! \return The value
+        T latest(int i) const {
+            check_nonempty();
+            return _column.at(i);
+        }
+
+        //! Get the latest value for every instance.
+        //! Throws an error if the channel is empty.
+        //! \return The column
+        const vector<T>& latest() const {
+            check_nonempty();
+            return _column;
+        }
+
+        private:
+
+        void check_nonempty() const {
+            if ( !_nonempty ) {
+                throw Exception("Tried to get the latest value in an empty batch channel.");
+            }
+        }
+
+        vector<T> _column;
+
+    };
+
+}
+
+#endif
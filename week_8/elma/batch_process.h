@@ -0,0 +1,92 @@
+#ifndef _BATCH_PROCESS_H
+#define _BATCH_PROCESS_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "elma.h"
+
+namespace elma {
+
+    using std::string;
+    using std::vector;
+    using std::map;
+
+    //! A process standing for many identical instances, stored as columns.
+
+    //! Scheduling thousands of plants as separate processes costs a virtual
+    //! update() call, a map lookup per channel access and a json value per
+    //! message, for every instance on every tick. A BatchProcess is scheduled
+    //! once and keeps each piece of per-instance state in a column: a vector
+    //! with one element per instance. Its update() advances every instance,
+    //! usually in loops over the columns that the compiler can vectorize, and
+    //! communicates through BatchChannels, which are columns too.
+    //!
+    //! Derived classes add their columns in the constructor or init(), and
+    //! may keep references to them: the references stay valid.
+    //! \include examples/batch_feedback.cc
+    template <typename T = double>
+    class BatchProcess : public Process {
+
+        public:
+
+        //! Constructor
+        //! \param name The name of the process
+        //! \param size The number of instances
+        BatchProcess(string name, int size) : Process(name), _size(size) {}
+
+        //! Getter
+        //! \return The number of instances
+        inline int size() const { return _size; }
+
+        //! Add a column of per-instance state
+        //! \param name The name of the column
+        //! \param initial The value of the column for every instance
+        //! \return The column
+        vector<T>& add_column(string name, T initial = T()) {
+            if ( _columns.find(name) != _columns.end() ) {
+                throw Exception("Batch process " + this->name() + " already has a column named " + name);
+            }
+            return _columns[name] = vector<T>(_size, initial);
+        }
+
+        //! Access a column. Throws an error if there is no such column.
+        //! \param name The name of the column
+        //! \return The column
+        vector<T>& column(string name) {
+            auto c = _columns.find(name);
+            if ( c == _columns.end() ) {
+                throw Exception("Batch process " + this->name() + " has no column named " + name);
+            }
+            return c->second;
+        }
+
+        //! Access a batch channel with the given name
+        //! \param name The name of the channel
+        //! \return A reference to the channel
+        BatchChannel<T>& batch_channel(string name) {
+            return Process::batch_channel<T>(name);
+        }
+
+        private:
+
+        int _size;
+        map<string, vector<T>> _columns; // nodes never move, so references to columns stay valid
+
+    };
+
+    //! Access a batch channel with the given name and element type
+    //! \param name The name of the channel
+    //! \return A reference to the channel
+    template <typename T>
+    BatchChannel<T>& Process::batch_channel(string name) {
+        if ( _manager_ptr == NULL ) {
+            throw Exception("Cannot access channels in a process before the process is scheduled.");
+        }
+        return _manager_ptr->batch_channel<T>(name);
+    }
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <benchmark/benchmark.h>
+#include "elma.h"
+
+//! \file
+//! Google Benchmark suite for the parts of elma on the hot path of a control
+//! loop: Manager ticks, idle coroutines, batch processes against separate
+//! processes, event dispatch and handler churn, watchdog timers, channels,
+//! state machine transitions and Client round trips to a local server. Run
+//! it with make json in this directory to write the results to suite.json,
+//! which can be compared between commits.
+
+using namespace elma;
+
+namespace {
+
+    class Idle : public Process {
+        public:
+        Idle() : Process("idle") {}
+        void init() {}
+        void start() {}
+        void update() {}
+        void stop() {}
+    };
+
+    // Ticks of a Manager running n processes that all update every tick
+    void BM_ManagerTick(benchmark::State& state) {
+        Manager m;
+        std::vector<std::unique_ptr<Idle>> processes;
+        for ( int i=0; i<state.range(0); i++ ) {
+            processes.emplace_back(new Idle());
+            m.schedule(*processes.back(), 0_ms);
+        }
+        m.init();
+        int ticks = 0;
+        for ( auto _ : state ) {
+            m.run(1_ms);
+            ticks += processes[0]->num_updates();
+        }
+        state.counters["ticks"] = benchmark::Counter(ticks, benchmark::Counter::kIsRate);
+        state.counters["seconds_per_tick"] = benchmark::Counter(ticks, 
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    }
+    BENCHMARK(BM_ManagerTick)->RangeMultiplier(4)->Range(1, 256)->UseRealTime();
+
+    // A behaviour that waits for an event that never comes
+    class Idler : public CoroutineProcess {
+        public:
+        Idler() : CoroutineProcess("idler") {}
+        Coroutine body() {
+            while ( true ) {
+                co_await event("never");
+            }
+        }
+    };
+
+    // A Manager update with n suspended coroutines, which should cost nothing
+    void BM_IdleCoroutines(benchmark::State& state) {
+        Manager m;
+        std::vector<std::unique_ptr<Idler>> idlers;
+        for ( int i=0; i<state.range(0); i++ ) {
+            idlers.emplace_back(new Idler());
+            m.schedule(*idlers.back());
+        }
+        m.init().start().update(); // runs each coroutine up to its co_await
+        for ( auto _ : state ) {
+            m.update();
+        }
+        m.stop();
+    }
+    BENCHMARK(BM_IdleCoroutines)->RangeMultiplier(16)->Range(1, 65536);
+
+    // A first order plant, x' = -x + 1, one process and one channel per instance
+    class Plant : public Process {
+        public:
+        Plant(std::string name) : Process(name) {}
+        void init() {}
+        void start() { x = 0; }
+        void update() {
+            x += 0.001 * ( 1 - x );
+            channel(name()).send(x);
+        }
+        void stop() {}
+        private:
+        double x;
+    };
+
+    // The same plant, with every instance in one column
+    class Plants : public BatchProcess<double> {
+        public:
+        Plants(int n) : BatchProcess("plants", n), x(add_column("x")) {}
+        void init() {}
+        void start() { std::fill(x.begin(), x.end(), 0); }
+        void update() {
+            double * y = batch_channel("plants").column().data();
+            for ( int i=0; i<size(); i++ ) {
+                y[i] = x[i] += 0.001 * ( 1 - x[i] );
+            }
+        }
+        void stop() {}
+        private:
+        std::vector<double>& x;
+    };
+
+    // Instance updates per second for n plants scheduled as separate processes
+    void BM_Plants(benchmark::State& state) {
+        Manager m;
+        std::vector<std::unique_ptr<Plant>> plants;
+        std::vector<std::unique_ptr<Channel>> channels;
+        for ( int i=0; i<state.range(0); i++ ) {
+            std::string name = "plant " + std::to_string(i);
+            plants.emplace_back(new Plant(name));
+            channels.emplace_back(new Channel(name, 1));
+            m.schedule(*plants.back(), 0_ms).add_channel(*channels.back());
+        }
+        m.init();
+        int ticks = 0;
+        for ( auto _ : state ) {
+            m.run(10_ms);
+            ticks += plants[0]->num_updates();
+        }
+        state.SetItemsProcessed(ticks * state.range(0));
+    }
+    BENCHMARK(BM_Plants)->RangeMultiplier(8)->Range(8, 4096)->UseRealTime();
+
+    // Instance updates per second for n plants in one BatchProcess
+    void BM_BatchPlants(benchmark::State& state) {
+        Manager m;
+        Plants plants(state.range(0));
+        BatchChannel<double> channel("plants", state.range(0));
+        m.schedule(plants, 0_ms).add_channel(channel).init();
+        int64_t ticks = 0;
+        for ( auto _ : state ) {
+            m.run(10_ms);
+            ticks += plants.num_updates();
+        }
+        state.SetItemsProcessed(ticks * state.range(0));
+    }
+    BENCHMARK(BM_BatchPlants)->RangeMultiplier(8)->Range(8, 1 << 18)->UseRealTime();
+
+    // One emit, dispatched to n handlers
+    void BM_Emit(benchmark::State& state) {
+        Manager m;
+        int calls = 0;
+        for ( int i=0; i<state.range(0); i++ ) {
+            m.watch("reading", [&calls](Event& e) { calls++; });
+        }
+        Event e("reading", 1.5);
+        for ( auto _ : state ) {
+            m.emit(e);
+        }
+        benchmark::DoNotOptimize(calls);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Emit)->RangeMultiplier(4)->Range(1, 64);
+
+    // A behaviour coming and going while n handlers watch the same event,
+    // followed by an emit that should not slow down as the churn goes on
+    void BM_HandlerChurn(benchmark::State& state) {
+        Manager m;
+        int calls = 0;
+        for ( int i=0; i<state.range(0); i++ ) {
+            m.watch("reading", [&calls](Event& e) { calls++; });
+        }
+        Event e("reading", 1.5);
+        for ( auto _ : state ) {
+            Subscription s = m.watch("reading", [&calls](Event& e) { calls++; });
+            s.unsubscribe();
+            m.emit(e);
+        }
+        benchmark::DoNotOptimize(calls);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_HandlerChurn)->RangeMultiplier(8)->Range(1, 512);
+
+    // Feeding one of n watchdogs: cancelling its timeout and arming a new one
+    void BM_WatchdogReset(benchmark::State& state) {
+        Manager m;
+        std::vector<Timer> watchdogs;
+        for ( int i=0; i<state.range(0); i++ ) {
+            watchdogs.push_back(m.emit_after(500_ms, Event("timeout")));
+        }
+        size_t i = 0;
+        for ( auto _ : state ) {
+            watchdogs[i].cancel();
+            watchdogs[i] = m.emit_after(500_ms, Event("timeout"));
+            i = ( i + 1 ) % watchdogs.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_WatchdogReset)->RangeMultiplier(16)->Range(1, 65536);
+
+    void BM_ChannelSendLatest(benchmark::State& state) {
+        Channel c("readings", state.range(0));
+        double x = 0;
+        for ( auto _ : state ) {
+            c.send(x += 0.5);
+            benchmark::DoNotOptimize(c.latest());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ChannelSendLatest)->Arg(1)->Arg(100)->Arg(10000);
+
+    class Mode : public State {
+        public:
+        Mode(std::string name) : State(name) {}
+        void entry(const Event& e) {}
+        void during() {}
+        void exit(const Event&) {}
+    };
+
+    // Transitions of a two state machine toggled by events
+    void BM_StateMachineTransition(benchmark::State& state) {
+        Manager m;
+        StateMachine fsm("toggle");
+        Mode off("off"), on("on");
+        fsm.set_initial(off)
+           .add_transition("switch", off, on)
+           .add_transition("switch", on, off);
+        m.schedule(fsm, 1_ms).init();
+        m.start();
+        Event e("switch");
+        for ( auto _ : state ) {
+            m.emit(e);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_StateMachineTransition);
+
+    // A get to a server on this machine, including waiting for the response
+    // and handing it to its handler with process_responses
+    void BM_ClientRoundTrip(benchmark::State& state) {
+
+        httplib::Server svr;
+        svr.Get("/find/1", [](const httplib::Request&, httplib::Response& res) {
+            json reading = { { "result", "ok" }, { "id", 1 }, { "temperature", 20.5 } };
+            res.set_content(reading.dump(), "application/json");
+        });
+        int port = svr.bind_to_any_port("localhost");
+        std::thread server([&svr]() { svr.listen_after_bind(); });
+
+        std::string url = "http://localhost:" + std::to_string(port) + "/find/1";
+        Client client;
+        int received = 0;
+        for ( auto _ : state ) {
+            client.get(url, [&received](json& response) {
+                if ( !response.is_null() ) {
+                    received++;
+                }
+            });
+            while ( client.num_responses() == 0 ) {
+                std::this_thread::yield();
+            }
+            client.process_responses();
+        }
+
+        svr.stop();
+        server.join();
+        if ( received != state.iterations() ) {
+            state.SkipWithError("Not every request got a response from the local server");
+        }
+
+    }
+    BENCHMARK(BM_ClientRoundTrip)->UseRealTime();
+
+}
+
+BENCHMARK_MAIN();
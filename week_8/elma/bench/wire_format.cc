@@ -0,0 +1,91 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "elma.h"
+
+//! \file
+//! Compares the size and encode/decode time of the wire formats that the
+//! Client and the week 9 server can negotiate, using sensor readings shaped
+//! like the responses to the server's /find endpoint.
+
+using namespace std::chrono;
+using namespace elma;
+
+json reading(int id) {
+    return {
+        { "result", "ok" },
+        { "id", id },
+        { "timestamp", 1551398400 + id },
+        { "x", 0.5 * id },
+        { "y", 12.25 - id },
+        { "temperature", 20.0 + 0.01 * id }
+    };
+}
+
+template<typename Encode, typename Decode>
+void measure(std::string name, const json& value, int reps, Encode encode, Decode decode) {
+
+    std::string bytes;
+    auto t0 = high_resolution_clock::now();
+    for ( int i=0; i<reps; i++ ) {
+        bytes = encode(value);
+    }
+    auto t1 = high_resolution_clock::now();
+    json result;
+    for ( int i=0; i<reps; i++ ) {
+        result = decode(bytes);
+    }
+    auto t2 = high_resolution_clock::now();
+
+    if ( result != value ) {
+        std::cout << name << ": round trip failed\n";
+    }
+
+    std::cout << std::setw(10) << name
+              << std::setw(12) << bytes.size()
+              << std::setw(16) << duration<double, std::micro>(t1 - t0).count() / reps
+              << std::setw(16) << duration<double, std::micro>(t2 - t1).count() / reps
+              << "\n";
+
+}
+
+void compare(int n, int reps) {
+
+    json value;
+    if ( n == 1 ) {
+        value = reading(0);
+    } else {
+        value = json::array();
+        for ( int i=0; i<n; i++ ) {
+            value.push_back(reading(i));
+        }
+    }
+
+    std::cout << "\n" << n << " reading(s), " << reps << " repetitions\n"
+              << std::setw(10) << "format"
+              << std::setw(12) << "bytes"
+              << std::setw(16) << "encode (us)"
+              << std::setw(16) << "decode (us)"
+              << "\n";
+
+    measure("json", value, reps,
+        [](const json& j) { return j.dump(); },
+        [](const std::string& s) { return Client::decode("application/json", s); });
+
+    measure("cbor", value, reps,
+        [](const json& j) { std::string s; json::to_cbor(j, s); return s; },
+        [](const std::string& s) { return Client::decode("application/cbor", s); });
+
+    measure("msgpack", value, reps,
+        [](const json& j) { std::string s; json::to_msgpack(j, s); return s; },
+        [](const std::string& s) { return Client::decode("application/msgpack", s); });
+
+}
+
+int main() {
+    compare(1, 10000);
+    compare(100, 1000);
+    compare(10000, 10);
+}
@@ -12,6 +12,22 @@ namespace elma {
         while ( _queue.size() > capacity() ) {
             _queue.pop_back();
         }
+        if ( !_next_handlers.empty() ) {
+            // Handlers may watch for the next value again, so take them out first
+            std::vector<std::function<void(json&)>> handlers;
+            handlers.swap(_next_handlers);
+            for ( auto& handler : handlers ) {
+                handler(value);
+            }
+        }
+        return *this;
+    }
+
+    //! Call a function with the next value sent on the channel, once
+    //! \param handler A function or lambda that takes the value and returns nothing
+    //! \return A reference to the channel, for chaining
+    Channel& Channel::watch_next(std::function<void(json&)> handler) {
+        _next_handlers.push_back(handler);
         return *this;
     }
 
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <deque>
+#include <vector>
+#include <functional>
 #include <json/json.h>
 
 #include "elma.h"
@@ -31,8 +33,15 @@ namespace elma {
         //! \param capacity The maximum number of values to store in the channel
         Channel(string name, int capacity) : _name(name), _capacity(capacity) {}
 
+        //! What co_await channel.next() waits for in a coroutine: the next value
+        //! sent on the channel. See Coroutine.
+        struct Next {
+            Channel& channel;
+        };
+
         Channel& send(json);
         Channel& flush();
+        Channel& watch_next(std::function<void(json&)> handler);
         json latest();
         json earliest();
 
@@ -56,11 +65,19 @@ namespace elma {
         //! \return The capacity of the channel      
         inline int capacity() { return _capacity; }
 
+        //! Wait for the next value sent on the channel, as in
+        //! @code
+        //!     json v = co_await channel("Velocity").next();
+        //! @endcode
+        //! \return An awaitable for a Coroutine
+        inline Next next() { return Next { *this }; }
+
         private:
 
         string _name;
         int _capacity;
         deque<json> _queue;
+        std::vector<std::function<void(json&)>> _next_handlers;
 
     };
 
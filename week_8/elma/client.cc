@@ -3,7 +3,6 @@
 #include "elma.h"
 #include <thread>
 #include <tuple>
-#include <iostream>
 
 namespace elma {
 
@@ -31,72 +30,344 @@ namespace elma {
     }
 
     Client& Client::get(std::string url, std::function<void(json&)> handler) {
+
+        if ( _cache_enabled ) {
+
+            std::unique_lock<std::mutex> lock(_cache_mtx);
+            auto entry = _cache.find(url);
+
+            if ( entry != _cache.end() && 
+                 std::chrono::high_resolution_clock::now() - entry->second.fetched < _cache_ttl ) {
+                _lru.splice(_lru.begin(), _lru, entry->second.lru);
+                _cache_hits++;
+                json value = entry->second.value;
+                lock.unlock(); // _deliver takes _mtx, which is never held with _cache_mtx
+                _deliver(value, handler);
+                return *this;
+            }
+
+            auto& waiting = _in_flight[url];
+            waiting.push_back(handler);
+            if ( waiting.size() == 1 ) {
+                std::string etag = entry == _cache.end() ? "" : entry->second.etag;
+                std::thread t(&Client::_cached_get_thread,this,url,etag);
+                t.detach();
+            }
+            return *this;
+
+        }
+
         std::thread t(&Client::_get_thread,this,url,handler);
         t.detach(); // detaching means we don't have to join later
+        return *this;
+
     }
 
-    Client& Client::process_responses() {
+    Client& Client::enable_cache(std::chrono::high_resolution_clock::duration ttl, size_t max_bytes) {
+        std::lock_guard<std::mutex> lock(_cache_mtx);
+        _cache_enabled = true;
+        _cache_ttl = ttl;
+        _cache_max_bytes = max_bytes;
+        return *this;
+    }
 
-        _mtx.lock();
+    Client& Client::disable_cache() {
+        std::lock_guard<std::mutex> lock(_cache_mtx);
+        _cache_enabled = false;
+        _cache.clear();
+        _lru.clear();
+        _cache_bytes = 0;
+        return *this;
+    }
 
-        for(auto response : _responses ) {
-            std::get<1>(response)(std::get<0>(response));
+    // The counters are updated by the request threads, so they are read under the lock
+    int Client::cache_hits() const {
+        std::lock_guard<std::mutex> lock(_cache_mtx);
+        return _cache_hits;
+    }
+
+    size_t Client::cache_bytes() const {
+        std::lock_guard<std::mutex> lock(_cache_mtx);
+        return _cache_bytes;
+    }
+
+    int Client::num_responses() const {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _responses.size();
+    }
+
+    const char * Client::content_type(format_type format) {
+        switch ( format ) {
+            case CBOR: return "application/cbor";
+            case MSGPACK: return "application/msgpack";
+            default: return "application/json";
         }
+    }
 
-        _responses.clear();
+    json Client::decode(const std::string& content_type, const std::string& body) {
+        if ( content_type.find("cbor") != std::string::npos ) {
+            return json::from_cbor(body);
+        } else if ( content_type.find("msgpack") != std::string::npos ) {
+            return json::from_msgpack(body);
+        } else {
+            return json::parse(body);
+        }
+    }
+
+    Client& Client::process_responses() {
 
+        // Handlers run without the lock, so that they can call get() themselves.
+        // Responses they cause are processed by the next call.
+        std::vector<std::tuple<json, std::function<void(json&)>>> responses;
+        _mtx.lock();
+        responses.swap(_responses);
         _mtx.unlock();
 
+        for(auto& response : responses ) {
+            std::get<1>(response)(std::get<0>(response));
+        }
+
         return *this;
 
     }
 
-    const std::shared_ptr<httplib::Response> Client::_get_aux(std::string url) {
+    const std::shared_ptr<httplib::Response> Client::_get_aux(std::string url, const std::string& etag) {
         auto parts = url_parts(url);
+        httplib::Headers headers;
+        if ( _format != JSON ) {
+            headers.emplace("Accept", std::string(content_type(_format)) + ", application/json;q=0.5");
+        }
+        if ( etag != "" ) {
+            headers.emplace("If-None-Match", etag);
+        }
+        // An explicit port, as in http://localhost:8080/find/1, overrides the default
+        std::string host = parts.first;
+        int port = _use_ssl ? 443 : 80;
+        auto colon = host.find(':');
+        if ( colon != std::string::npos ) {
+            port = std::stoi(host.substr(colon + 1));
+            host = host.substr(0, colon);
+        }
         if ( _use_ssl ) {
-            httplib::SSLClient cli(parts.first.c_str(), 443);
-            return cli.Get(parts.second.c_str());              
+            httplib::SSLClient cli(host.c_str(), port);
+            return cli.Get(parts.second.c_str(), headers);
         } else {
-            httplib::Client cli(parts.first.c_str(), 80);
-            return cli.Get(parts.second.c_str());              
+            httplib::Client cli(host.c_str(), port);
+            return cli.Get(parts.second.c_str(), headers);
         }        
     }
 
-    void Client::_get_thread(std::string url, std::function<void(json&)> handler) {
+    // Fetch and decode url. Returns the HTTP status, or 0 if there was no response.
+    // A 304 leaves result untouched.
+    int Client::_fetch(std::string url, const std::string& etag, json& result, std::string& result_etag, size_t& bytes) {
 
-        json json_response;
+        int status = 0;
 
         try {
 
-            auto response = _get_aux(url);
+            auto response = _get_aux(url, etag);
 
             if (response && response->status == 200) {
-                json_response = json::parse(response->body);
-             } else if ( response ) {
-                std::cout << "Warning:: Elma client connected to a server that returned Error: " 
-                          << response->status 
-                          << std::endl;
+                status = 200;
+                result = decode(response->get_header_value("Content-Type"), response->body);
+                result_etag = response->get_header_value("ETag");
+                bytes = response->body.size();
+            } else if ( response && response->status == 304 && etag != "" ) {
+                status = 304;
+            } else if ( response ) {
+                status = response->status;
+                ELMA_LOG_WARNING("Elma client connected to a server that returned Error: " << response->status);
             } else {
-                std::cout << "Warning:: Elma client returned no result" 
-                          << std::endl;
+                ELMA_LOG_WARNING("Elma client returned no result");
             }
 
         } catch (const httplib::Exception& e) {
-            std::cout << "Warning: Elma client failed: " 
-                      << e.what() 
-                      << "\n";
+            ELMA_LOG_WARNING("Elma client failed: " << e.what());
         } catch(const json::exception& e ) {
-            std::cout << "Warning: Elma client could not parse response: " 
-                      << e.what() 
-                      << "\n";
+            status = 0;
+            ELMA_LOG_WARNING("Elma client could not parse response: " << e.what());
         } catch (...) {
-            std::cout << "Warning: Elma client failed with no message\n";
+            ELMA_LOG_WARNING("Elma client failed with no message");
         }
 
+        return status;
+
+    }
+
+    void Client::_deliver(const json& value, std::function<void(json&)> handler) {
         _mtx.lock();
-        _responses.push_back(std::make_tuple(json_response, handler));
+        _responses.push_back(std::make_tuple(value, handler));
         _mtx.unlock();
+    }
+
+    void Client::_get_thread(std::string url, std::function<void(json&)> handler) {
+        json json_response;
+        std::string etag;
+        size_t bytes;
+        _fetch(url, "", json_response, etag, bytes);
+        _deliver(json_response, handler);
+    }
+
+    // Called with _cache_mtx held
+    void Client::_store(const std::string& url, const json& value, const std::string& etag, size_t bytes) {
+
+        auto entry = _cache.find(url);
+        if ( entry != _cache.end() ) {
+            _cache_bytes -= entry->second.bytes;
+            _lru.erase(entry->second.lru);
+            _cache.erase(entry);
+        }
+
+        if ( !_cache_enabled || bytes > _cache_max_bytes ) {
+            return;
+        }
+
+        while ( _cache_bytes + bytes > _cache_max_bytes ) {
+            auto oldest = _cache.find(_lru.back());
+            _cache_bytes -= oldest->second.bytes;
+            _cache.erase(oldest);
+            _lru.pop_back();
+        }
+
+        _lru.push_front(url);
+        _cache[url] = { value, etag, bytes, std::chrono::high_resolution_clock::now(), _lru.begin() };
+        _cache_bytes += bytes;
+
+    }
+
+    void Client::_cached_get_thread(std::string url, std::string etag) {
+
+        json json_response;
+        std::string new_etag;
+        size_t bytes = 0;
+        std::vector<std::function<void(json&)>> waiting;
 
-    }    
+        while ( true ) {
+
+            int status = _fetch(url, etag, json_response, new_etag, bytes);
+
+            std::lock_guard<std::mutex> lock(_cache_mtx);
+
+            auto entry = _cache.find(url);
+            if ( status == 304 && entry != _cache.end() ) {
+                // Not modified: reuse the value we already parsed
+                entry->second.fetched = std::chrono::high_resolution_clock::now();
+                _lru.splice(_lru.begin(), _lru, entry->second.lru);
+                json_response = entry->second.value;
+                _cache_hits += _in_flight[url].size();
+            } else if ( status == 304 ) {
+                // The cached response was evicted while we waited. Without
+                // If-None-Match the server has to send the whole body.
+                etag = "";
+                continue;
+            } else if ( status == 200 ) {
+                _store(url, json_response, new_etag, bytes);
+            }
+
+            waiting.swap(_in_flight[url]);
+            _in_flight.erase(url);
+            break;
+
+        }
+
+        for ( auto& handler : waiting ) {
+            _deliver(json_response, handler);
+        }
+
+    }
+
+    Client::~Client() {
+        for ( auto& s : _subscriptions ) {
+            s.second->active = false;
+            _stopped.push_back(s.second);
+        }
+        for ( auto& s : _stopped ) {
+            s->thread.join();
+        }
+    }
+
+    int Client::subscribe(std::string url, std::function<void(json&)> handler, int wait) {
+        _reap_subscriptions();
+        auto subscription = std::make_shared<Subscription>();
+        subscription->thread = std::thread(&Client::_subscribe_thread, this, url, handler, wait, subscription);
+        _subscriptions[_next_subscription] = subscription;
+        return _next_subscription++;
+    }
+
+    Client& Client::unsubscribe(int id) {
+        auto s = _subscriptions.find(id);
+        if ( s == _subscriptions.end() ) {
+            throw Exception("Tried to unsubscribe from an unknown subscription.");
+        }
+        s->second->active = false;
+        _stopped.push_back(s->second);
+        _subscriptions.erase(s);
+        _reap_subscriptions();
+        return *this;
+    }
+
+    int Client::num_subscriptions() const {
+        return _subscriptions.size();
+    }
+
+    bool Client::subscribed(int id) const {
+        return _subscriptions.count(id) > 0;
+    }
+
+    // Join the threads of stopped subscriptions that have already returned
+    void Client::_reap_subscriptions() {
+        for ( auto s = _stopped.begin(); s != _stopped.end(); ) {
+            if ( (*s)->done ) {
+                (*s)->thread.join();
+                s = _stopped.erase(s);
+            } else {
+                s++;
+            }
+        }
+    }
+
+    void Client::_subscribe_thread(std::string url, std::function<void(json&)> handler, int wait,
+                                   std::shared_ptr<Subscription> subscription) {
+
+        std::string cursor;
+
+        while ( subscription->active ) {
+
+            std::string request = url + ( url.find('?') == std::string::npos ? "?" : "&" )
+                                + "wait=" + std::to_string(wait);
+            if ( cursor != "" ) {
+                request += "&after=" + cursor;
+            }
+
+            json response;
+            std::string etag;
+            size_t bytes;
+            int status = _fetch(request, "", response, etag, bytes);
+
+            if ( !subscription->active ) {
+                break;
+            }
+
+            if ( status == 200 && response.is_object() && response["items"].is_array() ) {
+                if ( response["next"].is_string() ) {
+                    cursor = response["next"].get<std::string>();
+                } else if ( !response["next"].is_null() ) {
+                    cursor = response["next"].dump();
+                }
+                for ( auto& item : response["items"] ) {
+                    _deliver(item, handler);
+                }
+            } else {
+                // Back off for a second so that a server that is down is not flooded
+                for ( int i=0; i<10 && subscription->active; i++ ) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                }
+            }
+
+        }
+
+        subscription->done = true;
+
+    }
 
-};
\ No newline at end of file
+};
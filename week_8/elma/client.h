@@ -6,6 +6,11 @@
 
 #include <string>
 #include <tuple>
+#include <list>
+#include <chrono>
+#include <unordered_map>
+#include <map>
+#include <atomic>
 #include "elma.h"
 
 namespace elma {
@@ -35,9 +40,27 @@ namespace elma {
 
         public:
 
+        //! Encodings the client can ask a server to use for its responses
+        typedef enum { JSON, CBOR, MSGPACK } format_type;
+
         //! Construct a new client. Only the Manager would normall do this, although
         //! a client can work as a standalone object.
-        Client() : _use_ssl(false) {}
+        Client() : _use_ssl(false), _format(JSON), _cache_enabled(false),
+                   _cache_bytes(0), _cache_hits(0), _next_subscription(0) {}
+
+        //! Destructor. Stops all subscriptions, waiting at most one poll for each to return.
+        ~Client();
+
+        //! Ask servers to respond in a compact binary encoding. The client sends the
+        //! format in its Accept header, along with JSON as a fallback, and decodes
+        //! whatever the server actually returns based on its Content-Type, so servers
+        //! that only speak JSON keep working. Handlers receive json in every case.
+        //! \param format One of JSON, CBOR or MSGPACK
+        //! \return A reference to the client, for chaining
+        inline Client& use_format(format_type format) { _format = format; return *this; }
+
+        //! \return The format requested from servers
+        inline format_type format() const { return _format; }
 
         //! Send an HTTP GET request to a specific URL and register a handler 
         //! to deal with the response. This method assumes the server will respond
@@ -47,6 +70,63 @@ namespace elma {
         //! \return A reference to the client, for chaining
         Client& get(std::string url, std::function<void(json&)> handler);
 
+        //! Cache responses by URL. While a cached response is younger than ttl, get()
+        //! hands it to the handler without contacting the server. After that, the
+        //! client revalidates with If-None-Match when the server sent an ETag, and
+        //! reuses the cached value without re-parsing if the server answers 304.
+        //! Concurrent get() calls for the same URL share a single outstanding request.
+        //! The least recently used responses are evicted once the cached bodies
+        //! exceed max_bytes. For example,
+        //! @code
+        //!     manager.client().enable_cache(5_s);
+        //! @endcode
+        //! \param ttl How long a response is used without revalidating it
+        //! \param max_bytes The total size of response bodies to keep
+        //! \return A reference to the client, for chaining
+        Client& enable_cache(std::chrono::high_resolution_clock::duration ttl, size_t max_bytes = 1 << 20);
+
+        //! Stop caching and discard all cached responses. Requests already in flight
+        //! still deliver their responses to every waiting handler.
+        //! \return A reference to the client, for chaining
+        Client& disable_cache();
+
+        //! \return The number of get() calls answered from the cache, including 304 revalidations
+        int cache_hits() const;
+
+        //! \return The total size of the cached response bodies, in bytes
+        size_t cache_bytes() const;
+
+        //! Subscribe to a long polling endpoint, such as /subscribe on the week 9 server.
+        //! The client keeps one request outstanding at a time in a background thread.
+        //! The server should hold each request until it has new items or wait seconds
+        //! have passed, and respond with an object of the form
+        //! `{ "items": [ ... ], "next": cursor }`. Each item is handed to the handler
+        //! by process_responses(), just like responses to get(), and the cursor is
+        //! sent back as the after parameter of the next request. For example,
+        //! @code
+        //!     client.subscribe("http://localhost/subscribe?region=0,0,10,10", [](json& reading) {
+        //!         std::cout << reading["temperature"] << "\n";
+        //!     });
+        //! @endcode
+        //! \param url The url of the endpoint, which may already have query parameters
+        //! \param handler The handler, called once for every item received
+        //! \param wait The longest time, in seconds, the server should hold a request
+        //! \return An id that can be passed to unsubscribe()
+        int subscribe(std::string url, std::function<void(json&)> handler, int wait = 5);
+
+        //! Stop a subscription. Items that have already arrived are still handled by
+        //! the next call to process_responses().
+        //! \param id The id returned by subscribe()
+        //! \return A reference to the client, for chaining
+        Client& unsubscribe(int id);
+
+        //! \return The number of active subscriptions
+        int num_subscriptions() const;
+
+        //! \param id An id returned by subscribe()
+        //! \return True if the subscription has not been stopped
+        bool subscribed(int id) const;
+
         //! Process all responses received so far
         //! \return A reference to the client, for chaining        
         Client& process_responses();
@@ -57,15 +137,64 @@ namespace elma {
         std::pair<std::string,std::string> url_parts(std::string url);
 
         //! \return The number of unprocessed responses
-        int num_responses() const { return _responses.size(); }
+        int num_responses() const;
+
+        //! \return The MIME type used for a format
+        static const char * content_type(format_type format);
+
+        //! Decode a response body according to its Content-Type. Bodies that are
+        //! not CBOR or MessagePack are parsed as JSON.
+        //! \param content_type The value of the Content-Type header
+        //! \param body The body of the response
+        //! \return The decoded value
+        static json decode(const std::string& content_type, const std::string& body);
 
         private:
 
+        struct Subscription {
+            Subscription() : active(true), done(false) {}
+            std::atomic<bool> active, done;
+            std::thread thread;
+        };
+
+        struct CacheEntry {
+            json value;
+            std::string etag;
+            size_t bytes;
+            std::chrono::high_resolution_clock::time_point fetched;
+            std::list<std::string>::iterator lru;
+        };
+
         void _get_thread(std::string url, std::function<void(json&)> handler);
-        const std::shared_ptr<httplib::Response> _get_aux(std::string url);
+        void _cached_get_thread(std::string url, std::string etag);
+        void _subscribe_thread(std::string url, std::function<void(json&)> handler, int wait, 
+                               std::shared_ptr<Subscription> subscription);
+        void _reap_subscriptions();
+        int _fetch(std::string url, const std::string& etag, json& result, std::string& result_etag, size_t& bytes);
+        void _deliver(const json& value, std::function<void(json&)> handler);
+        void _store(const std::string& url, const json& value, const std::string& etag, size_t bytes);
+        const std::shared_ptr<httplib::Response> _get_aux(std::string url, const std::string& etag);
         std::vector<std::tuple<json, std::function<void(json&)>>> _responses;
         bool _use_ssl;
-        std::mutex _mtx;
+        format_type _format;
+        mutable std::mutex _mtx;
+
+        // Response cache, guarded by _cache_mtx. _mtx is never taken while
+        // _cache_mtx is held.
+        bool _cache_enabled;
+        std::chrono::high_resolution_clock::duration _cache_ttl;
+        size_t _cache_max_bytes, _cache_bytes;
+        int _cache_hits;
+        std::unordered_map<std::string, CacheEntry> _cache;
+        std::list<std::string> _lru; // most recently used first
+        std::unordered_map<std::string, std::vector<std::function<void(json&)>>> _in_flight;
+        mutable std::mutex _cache_mtx;
+
+        // Subscriptions by id. Stopped subscriptions move to _stopped until their
+        // threads finish.
+        int _next_subscription;
+        std::map<int, std::shared_ptr<Subscription>> _subscriptions;
+        std::vector<std::shared_ptr<Subscription>> _stopped;
 
     };
 
@@ -0,0 +1,250 @@
+#ifndef _COROUTINE_H
+#define _COROUTINE_H
+
+// Coroutines need C++20. Translation units built with an earlier standard
+// see the rest of elma without them.
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <string>
+
+#include "elma.h"
+
+namespace elma {
+
+    using std::string;
+
+    //! What co_await sleep(duration) waits for in a Coroutine
+    struct Sleep {
+        high_resolution_clock::duration duration;
+    };
+
+    //! What co_await event(name) waits for in a Coroutine
+    struct NextEvent {
+        string name;
+    };
+
+    //! Wait in a Coroutine, as in co_await sleep(10_ms)
+    //! \param duration How long to wait, from the time of the call
+    //! \return An awaitable for a Coroutine
+    inline Sleep sleep(high_resolution_clock::duration duration) { return Sleep { duration }; }
+
+    //! Wait in a Coroutine for the next event with a name, as in
+    //! @code
+    //!     Event e = co_await event("door opened");
+    //! @endcode
+    //! \param name The name of the event
+    //! \return An awaitable for a Coroutine
+    inline NextEvent event(string name) { return NextEvent { name }; }
+
+    //! Sequential behaviour run by a Manager.
+
+    //! A function returning Coroutine can co_await sleep(), event() and
+    //! Channel::next(). Each suspends the coroutine and registers a wake up
+    //! with the Manager: a timer, a one shot event handler or a one shot
+    //! channel handler. The Manager resumes the coroutine from update() once
+    //! the condition is met and never looks at it otherwise, so a suspended
+    //! coroutine costs no time on the ticks in between. Events and channel
+    //! values wake it through a zero delay timer: it resumes on the update
+    //! after the one in which the event was emitted or the value sent, or on
+    //! the next update if that happened between updates.
+    //!
+    //! A Coroutine owns its frame, which is destroyed with it. Wake ups
+    //! still pending when that happens are ignored. Exceptions thrown in the
+    //! coroutine propagate out of the Manager update() that resumed it.
+    //! Usually coroutines are run by a CoroutineProcess.
+    //! \include examples/coroutine.cc
+    class Coroutine {
+
+        public:
+
+        class promise_type;
+        typedef std::coroutine_handle<promise_type> handle_type;
+
+        //! Waits for a timer
+        struct SleepAwaiter {
+            promise_type& promise;
+            high_resolution_clock::duration duration;
+            bool await_ready() { return false; }
+            void await_suspend(handle_type h) { promise.manager->call_after(duration, promise.waker(h)); }
+            void await_resume() {}
+        };
+
+        //! Waits for an event, which it returns. Its handler is unsubscribed
+        //! if the frame is destroyed first.
+        struct EventAwaiter {
+            promise_type& promise;
+            Event event;
+            Subscription subscription;
+            ~EventAwaiter() { subscription.unsubscribe(); }
+            bool await_ready() { return false; }
+            void await_suspend(handle_type h) {
+                std::weak_ptr<bool> alive = promise.alive;
+                Manager * manager = promise.manager;
+                std::function<void()> wake = promise.waker(h);
+                subscription = manager->watch_next(event.name(), [this, alive, manager, wake](Event& e) {
+                    if ( !alive.expired() ) {
+                        event = e;
+                        manager->call_after(high_resolution_clock::duration::zero(), wake);
+                    }
+                });
+            }
+            Event await_resume() { return event; }
+        };
+
+        //! Waits for a value on a channel, which it returns
+        struct ChannelAwaiter {
+            promise_type& promise;
+            Channel& channel;
+            json value;
+            bool await_ready() { return false; }
+            void await_suspend(handle_type h) {
+                std::weak_ptr<bool> alive = promise.alive;
+                Manager * manager = promise.manager;
+                std::function<void()> wake = promise.waker(h);
+                channel.watch_next([this, alive, manager, wake](json& v) {
+                    if ( !alive.expired() ) {
+                        value = v;
+                        manager->call_after(high_resolution_clock::duration::zero(), wake);
+                    }
+                });
+            }
+            json await_resume() { return value; }
+        };
+
+        //! The state the compiler keeps in the coroutine frame
+        class promise_type {
+
+            public:
+
+            Coroutine get_return_object() { return Coroutine(handle_type::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { exception = std::current_exception(); }
+
+            SleepAwaiter await_transform(Sleep s) { return { *this, s.duration }; }
+            EventAwaiter await_transform(NextEvent e) { return { *this, Event(e.name), Subscription() }; }
+            ChannelAwaiter await_transform(Channel::Next n) { return { *this, n.channel, json() }; }
+
+            //! Other awaitables are awaited as they are
+            template <typename A> A&& await_transform(A&& awaitable) { return std::forward<A>(awaitable); }
+
+            //! A function that resumes the coroutine, unless its frame is gone
+            std::function<void()> waker(handle_type h) {
+                std::weak_ptr<bool> token = alive;
+                return [h, token]() {
+                    if ( !token.expired() ) {
+                        h.resume();
+                        if ( h.promise().exception ) {
+                            std::rethrow_exception(std::exchange(h.promise().exception, nullptr));
+                        }
+                    }
+                };
+            }
+
+            Manager * manager = NULL;
+            std::exception_ptr exception;
+            std::shared_ptr<bool> alive = std::make_shared<bool>(true); // expires with the frame
+
+        };
+
+        //! Default constructor, for a Coroutine with nothing to run
+        Coroutine() : _handle(nullptr) {}
+        Coroutine(Coroutine&& other) : _handle(std::exchange(other._handle, nullptr)) {}
+        Coroutine& operator=(Coroutine&& other) {
+            if ( this != &other ) {
+                if ( _handle ) {
+                    _handle.destroy();
+                }
+                _handle = std::exchange(other._handle, nullptr);
+            }
+            return *this;
+        }
+        Coroutine(const Coroutine&) = delete;
+        Coroutine& operator=(const Coroutine&) = delete;
+        ~Coroutine() {
+            if ( _handle ) {
+                _handle.destroy();
+            }
+        }
+
+        //! Run the coroutine up to its first co_await on the manager's next
+        //! update. Throws an error if it has already been started.
+        //! \param manager The manager that will resume the coroutine
+        //! \return A reference to the coroutine, for chaining
+        Coroutine& start(Manager& manager) {
+            if ( !_handle || _handle.promise().manager != NULL ) {
+                throw Exception("Tried to start a coroutine that is empty or already started.");
+            }
+            _handle.promise().manager = &manager;
+            manager.call_after(high_resolution_clock::duration::zero(), _handle.promise().waker(_handle));
+            return *this;
+        }
+
+        //! Getter
+        //! \return True if the coroutine has returned, or if there is none
+        inline bool done() const { return !_handle || _handle.done(); }
+
+        private:
+
+        explicit Coroutine(handle_type h) : _handle(h) {}
+
+        handle_type _handle;
+
+    };
+
+    //! A process whose behaviour is a coroutine.
+
+    //! Derived classes implement body(), which the process starts afresh
+    //! each time the Manager starts it and destroys when the Manager stops
+    //! it. Schedule it without a period, with Manager::schedule(process), so
+    //! that it is never polled: it runs only when what it awaits happens.
+    //! \include examples/coroutine.cc
+    class CoroutineProcess : public Process {
+
+        public:
+
+        //! Constructor
+        //! \param name The name of the process
+        CoroutineProcess(string name) : Process(name) {}
+
+        //! The behaviour of the process. Override this with a coroutine.
+        //! \return The coroutine
+        virtual Coroutine body() = 0;
+
+        //! Initialization method. May be overridden by derived classes.
+        void init() {}
+
+        //! Starts body(). Throws an error if the process is not scheduled.
+        void start() final {
+            if ( manager() == NULL ) {
+                throw Exception("Cannot start a coroutine process before the process is scheduled.");
+            }
+            _coroutine = body();
+            _coroutine.start(*manager());
+        }
+
+        //! Coroutine processes are not polled: this does nothing.
+        void update() final {}
+
+        //! Destroys the running body(), wherever it is suspended
+        void stop() final { _coroutine = Coroutine(); }
+
+        //! Getter
+        //! \return True if body() has returned, or has not been started
+        inline bool done() const { return _coroutine.done(); }
+
+        private:
+
+        Coroutine _coroutine;
+
+    };
+
+}
+
+#endif
+
+#endif
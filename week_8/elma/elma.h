@@ -4,10 +4,14 @@
 // Utilities
 #include "literals.h"
 #include "exceptions.h"
+#include "logger.h"
 
 // Communications
 #include "channel.h"
+#include "batch_channel.h"
 #include "event.h"
+#include "timer.h"
+#include "subscription.h"
 
 // HTTP
 #include "client.h"
@@ -15,6 +19,8 @@
 // Processes
 #include "process.h"
 #include "manager.h"
+#include "batch_process.h"
+#include "coroutine.h"
 
 // State Machines
 #include "state.h"
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include "elma.h"
+
+//! \file
+//! The cruise control example of feedback.cc, for a whole fleet of cars at
+//! once. Each car has its own desired speed. Instead of two processes and two
+//! channels per car, there are two batch processes and two batch channels,
+//! each holding one column with an entry per car.
+
+using namespace std::chrono;
+using std::vector;
+using namespace elma;
+
+class Cars : public BatchProcess<double> {
+    public:
+    Cars(std::string name, int n) : BatchProcess(name, n), velocity(add_column("velocity")) {}
+    void init() {}
+    void start() {
+        std::fill(velocity.begin(), velocity.end(), 0);
+    }
+    void update() {
+        BatchChannel<double>& throttle = batch_channel("Throttle");
+        double * v = velocity.data(),
+               dt = delta() / 1000;
+        // One pass over contiguous columns, which the compiler can vectorize
+        if ( throttle.nonempty() ) {
+            const double * force = throttle.latest().data();
+            for ( int i=0; i<size(); i++ ) {
+                v[i] += dt * ( - k * v[i] + force[i] ) / m;
+            }
+        } else {
+            for ( int i=0; i<size(); i++ ) {
+                v[i] += dt * ( - k * v[i] ) / m;
+            }
+        }
+        batch_channel("Velocity").send(velocity);
+    }
+    void stop() {}
+    private:
+    vector<double>& velocity;
+    const double k = 0.02;
+    const double m = 1000;
+};
+
+class CruiseControls : public BatchProcess<double> {
+    public:
+    CruiseControls(std::string name, int n) : BatchProcess(name, n), desired_speed(add_column("desired speed")) {
+        for ( int i=0; i<n; i++ ) {
+            desired_speed[i] = 40.0 + 20.0 * i / n;
+        }
+    }
+    void init() {}
+    void start() {}
+    void update() {
+        BatchChannel<double>& velocity = batch_channel("Velocity");
+        vector<double>& throttle = batch_channel("Throttle").column();
+        if ( velocity.nonempty() ) {
+            const double * speed = velocity.latest().data();
+            for ( int i=0; i<size(); i++ ) {
+                throttle[i] = -KP * (speed[i] - desired_speed[i]);
+            }
+        }
+    }
+    void stop() {}
+    private:
+    vector<double>& desired_speed;
+    const double KP = 314.15;
+};
+
+int main() {
+
+    const int n = 100000;
+
+    Manager m;
+
+    Cars cars("Cars", n);
+    CruiseControls cc("Controls", n);
+    BatchChannel<double> throttle("Throttle", n);
+    BatchChannel<double> velocity("Velocity", n);
+
+    m.schedule(cars, 10_ms)
+     .schedule(cc, 10_ms)
+     .add_channel(throttle)
+     .add_channel(velocity)
+     .init()
+     .run(1000_ms);
+
+    for ( int i=0; i<n; i+=n/4 ) {
+        std::cout << "car " << i << ": v = " << velocity.latest(i) << " m/s, "
+                  << "desired " << cc.column("desired speed")[i] << " m/s\n";
+    }
+    std::cout << cars.num_updates() << " updates of " << n << " cars\n";
+
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <chrono>
+#include "elma.h"
+
+//! \file
+//! A door written as a coroutine. Where a StateMachine would need a state
+//! for each step and a flag for each timeout, the door's behaviour reads top
+//! to bottom: wait to be called, open, wait for a while, close. While it
+//! waits the manager does not update it at all.
+
+using namespace std::chrono;
+using namespace elma;
+
+class Door : public CoroutineProcess {
+    public:
+    Door(std::string name) : CoroutineProcess(name) {}
+    Coroutine body() {
+        while ( true ) {
+            Event e = co_await event("call");
+            std::cout << manager()->elapsed() / 1_ms << " ms: called to floor " << e.value() << ", opening\n";
+            co_await sleep(30_ms);
+            channel("Door").send("open");
+            co_await sleep(100_ms);
+            std::cout << manager()->elapsed() / 1_ms << " ms: closing\n";
+            channel("Door").send("closed");
+        }
+    }
+};
+
+class Passenger : public CoroutineProcess {
+    public:
+    Passenger(std::string name) : CoroutineProcess(name) {}
+    Coroutine body() {
+        for ( int floor=1; floor<=3; floor++ ) {
+            co_await sleep(200_ms);
+            emit(Event("call", floor));
+            json state;
+            do {
+                state = co_await channel("Door").next();
+            } while ( state != "closed" );
+            std::cout << manager()->elapsed() / 1_ms << " ms: " << name() << " is on floor " << floor << "\n";
+        }
+    }
+};
+
+int main() {
+
+    Manager m;
+
+    Door door("door");
+    Passenger passenger("passenger");
+    Channel state("Door");
+
+    m.schedule(door)
+     .schedule(passenger)
+     .add_channel(state)
+     .init()
+     .run(1000_ms);
+
+    std::cout << "passenger done: " << passenger.done() << "\n";
+
+}
@@ -0,0 +1,418 @@
+#ifndef _LOGGER_H
+#define _LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! \file
+
+//! Messages with a level below ELMA_LOG_LEVEL are removed at compile time
+//! (0 = debug, 1 = info, 2 = warning, 3 = error, 4 = off). Set it with
+//! -DELMA_LOG_LEVEL=2, for example, to strip debug and info messages entirely.
+#ifndef ELMA_LOG_LEVEL
+#define ELMA_LOG_LEVEL 1
+#endif
+
+//! Number of records each thread can queue before the flusher catches up
+#ifndef ELMA_LOG_BUFFER_SIZE
+#define ELMA_LOG_BUFFER_SIZE 256
+#endif
+
+//! Maximum length of a single message. Longer messages are truncated.
+#define ELMA_LOG_MESSAGE_SIZE 232
+
+//! Log a message at the given level. The message is anything that can be
+//! written to a std::ostream, as in
+//! @code
+//!     ELMA_LOG(elma::Logger::INFO, "got " << n << " readings");
+//! @endcode
+//! The statement compiles to nothing when level is below ELMA_LOG_LEVEL.
+#define ELMA_LOG(level, message)                                             \
+    do {                                                                     \
+        if ( (level) >= ELMA_LOG_LEVEL &&                                    \
+             elma::Logger::instance().enabled(level) ) {                     \
+            std::ostringstream& _elma_log_os = elma::Logger::stream();       \
+            _elma_log_os << message;                                         \
+            elma::Logger::instance().write(level, _elma_log_os);             \
+        }                                                                    \
+    } while (0)
+
+#define ELMA_LOG_DEBUG(message)   ELMA_LOG(elma::Logger::DEBUG, message)
+#define ELMA_LOG_INFO(message)    ELMA_LOG(elma::Logger::INFO, message)
+#define ELMA_LOG_WARNING(message) ELMA_LOG(elma::Logger::WARNING, message)
+#define ELMA_LOG_ERROR(message)   ELMA_LOG(elma::Logger::ERROR, message)
+
+namespace elma {
+
+    //! An asynchronous, buffered logger shared by every thread in a process.
+
+    //! Each thread writes records into its own fixed size ring buffer without
+    //! taking a lock. A background thread periodically drains all of the buffers,
+    //! orders the records by time, and writes them to the output in one batch, so
+    //! logging never blocks on stdout. If a thread logs faster than the flusher
+    //! drains, new records are dropped and counted rather than blocking the caller.
+    //! Use the ELMA_LOG_* macros rather than calling write() directly, so that
+    //! disabled levels cost nothing. For example,
+    //! @code
+    //!     elma::Logger::instance().set_format(elma::Logger::JSON_LINES);
+    //!     ELMA_LOG_WARNING("server returned " << response->status);
+    //! @endcode
+    //! The logger is header only so that programs that do not link against
+    //! libelma, such as the week 9 server, can use it too.
+    class Logger {
+
+        public:
+
+        //! Severity of a message
+        typedef enum { DEBUG, INFO, WARNING, ERROR } level_type;
+
+        //! Output formats.
+        //! - TEXT: `2019-03-01T12:00:00.123456Z INFO [thread] message`
+        //! - JSON_LINES: one `{"ts":...,"level":"...","thread":...,"msg":"..."}` object per line, ts in ns since the epoch
+        //! - BINARY: records of int64 ts (ns), uint32 thread, uint8 level, uint16 length, then length bytes of message, in host byte order
+        typedef enum { TEXT, JSON_LINES, BINARY } format_type;
+
+        //! A single queued message
+        struct Record {
+            int64_t timestamp;
+            uint32_t thread;
+            uint16_t length;
+            uint8_t level;
+            char message[ELMA_LOG_MESSAGE_SIZE];
+        };
+
+        //! \return The process wide logger. It is created, and its flusher started, on first use.
+        static Logger& instance() {
+            static Logger logger;
+            return logger;
+        }
+
+        //! \return A per-thread stream that the logging macros use to format messages
+        //! without allocating a new stream each time
+        static std::ostringstream& stream() {
+            thread_local std::ostringstream os;
+            os.str("");
+            os.clear();
+            return os;
+        }
+
+        //! Whether messages at the given level are currently written. Levels below
+        //! ELMA_LOG_LEVEL are never written, regardless of the runtime level.
+        //! \param level The level
+        //! \return True or false
+        inline bool enabled(int level) const {
+            return level >= ELMA_LOG_LEVEL && level >= _level.load(std::memory_order_relaxed);
+        }
+
+        //! Set the minimum level written at runtime
+        //! \param level The level
+        //! \return A reference to the logger, for chaining
+        inline Logger& set_level(level_type level) { _level = level; return *this; }
+
+        //! Set the output format. Takes effect for records flushed after the call.
+        //! \param format One of TEXT, JSON_LINES or BINARY
+        //! \return A reference to the logger, for chaining
+        inline Logger& set_format(format_type format) { _format = format; return *this; }
+
+        //! Send output to an open file. The logger does not close it.
+        //! \param file The file, for example stdout or stderr
+        //! \return A reference to the logger, for chaining
+        Logger& set_output(FILE * file) {
+            _replace_output(file, false);
+            return *this;
+        }
+
+        //! Send output to a file, which is opened for appending and closed by the logger
+        //! \param path The path to the file
+        //! \return A reference to the logger, for chaining
+        Logger& set_output(const std::string& path) {
+            FILE * file = std::fopen(path.c_str(), _format == BINARY ? "ab" : "a");
+            if ( file == NULL ) {
+                throw std::runtime_error("Elma Error: Logger could not open " + path);
+            }
+            _replace_output(file, true);
+            return *this;
+        }
+
+        //! Set how often the background thread drains the buffers
+        //! \param interval The interval
+        //! \return A reference to the logger, for chaining
+        Logger& set_flush_interval(std::chrono::milliseconds interval) {
+            _interval_ms = interval.count();
+            return *this;
+        }
+
+        //! Queue a message from the calling thread. Does not block and does no I/O.
+        //! \param level The level of the message
+        //! \param message A stream whose contents are the message
+        void write(int level, const std::ostringstream& message) {
+            write(level, message.str());
+        }
+
+        //! Queue a message from the calling thread. Does not block and does no I/O.
+        //! \param level The level of the message
+        //! \param message The message
+        void write(int level, const std::string& message) {
+            if ( !_local_buffer().push(level, message) ) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                _wake.notify_one();
+            }
+        }
+
+        //! Write all queued records to the output now, from the calling thread
+        //! \return A reference to the logger, for chaining
+        Logger& flush() {
+            std::lock_guard<std::mutex> lock(_write_mtx);
+            _drain();
+            return *this;
+        }
+
+        //! \return The number of records dropped because a thread's buffer was full
+        inline unsigned long dropped() const { return _dropped.load(); }
+
+        //! \return The name of a level, as used in the text and JSON formats
+        static const char * level_name(int level) {
+            static const char * names[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+            return level >= 0 && level <= ERROR ? names[level] : "UNKNOWN";
+        }
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        ~Logger() {
+            {
+                std::lock_guard<std::mutex> lock(_wake_mtx);
+                _running = false;
+            }
+            _wake.notify_one();
+            _flusher.join();
+            flush();
+            _close_output();
+        }
+
+        private:
+
+        // A single-producer, single-consumer ring of records. The owning thread
+        // advances _head and the flusher advances _tail.
+        class Buffer {
+
+            public:
+
+            Buffer() : _head(0), _tail(0), _retired(false) {}
+
+            bool push(int level, const std::string& message) {
+                size_t head = _head.load(std::memory_order_relaxed);
+                if ( head - _tail.load(std::memory_order_acquire) == ELMA_LOG_BUFFER_SIZE ) {
+                    return false;
+                }
+                Record& r = _records[head % ELMA_LOG_BUFFER_SIZE];
+                r.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                r.thread = _thread_id();
+                r.level = (uint8_t) level;
+                r.length = (uint16_t) std::min(message.size(), (size_t) ELMA_LOG_MESSAGE_SIZE);
+                std::memcpy(r.message, message.data(), r.length);
+                _head.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            void drain(std::vector<Record>& out) {
+                size_t tail = _tail.load(std::memory_order_relaxed),
+                       head = _head.load(std::memory_order_acquire);
+                for ( ; tail != head; tail++ ) {
+                    out.push_back(_records[tail % ELMA_LOG_BUFFER_SIZE]);
+                }
+                _tail.store(tail, std::memory_order_release);
+            }
+
+            inline void retire() { _retired = true; }
+            inline bool retired() const { return _retired.load(); }
+
+            private:
+
+            static uint32_t _thread_id() {
+                thread_local uint32_t id = (uint32_t) std::hash<std::thread::id>()(std::this_thread::get_id());
+                return id;
+            }
+
+            std::atomic<size_t> _head, _tail;
+            std::atomic<bool> _retired;
+            Record _records[ELMA_LOG_BUFFER_SIZE];
+
+        };
+
+        // Marks the calling thread's buffer as retired when the thread exits, so
+        // the flusher can release it once it has been drained.
+        struct BufferHandle {
+            std::shared_ptr<Buffer> buffer;
+            ~BufferHandle() { if ( buffer ) buffer->retire(); }
+        };
+
+        Logger() : _level(ELMA_LOG_LEVEL), _format(TEXT), _out(stdout), _owns_out(false),
+                   _interval_ms(50), _running(true), _dropped(0), _reported(0) {
+            _flusher = std::thread(&Logger::_flush_thread, this);
+        }
+
+        Buffer& _local_buffer() {
+            thread_local BufferHandle handle;
+            if ( !handle.buffer ) {
+                handle.buffer = std::make_shared<Buffer>();
+                std::lock_guard<std::mutex> lock(_buffers_mtx);
+                _buffers.push_back(handle.buffer);
+            }
+            return *handle.buffer;
+        }
+
+        void _flush_thread() {
+            std::unique_lock<std::mutex> lock(_wake_mtx);
+            while ( _running ) {
+                _wake.wait_for(lock, std::chrono::milliseconds(_interval_ms.load()));
+                lock.unlock();
+                flush();
+                lock.lock();
+            }
+        }
+
+        // Called with _write_mtx held
+        void _drain() {
+
+            _batch.clear();
+
+            {
+                std::lock_guard<std::mutex> lock(_buffers_mtx);
+                // A buffer found retired before it is drained has had its last
+                // record pushed, so it is empty afterwards and can go. One that
+                // retires during the drain is kept until the next one.
+                size_t kept = 0;
+                for ( auto& buffer : _buffers ) {
+                    bool retired = buffer->retired();
+                    buffer->drain(_batch);
+                    if ( !retired ) {
+                        _buffers[kept++] = buffer;
+                    }
+                }
+                _buffers.resize(kept);
+            }
+
+            unsigned long dropped = _dropped.load();
+            if ( _batch.empty() && dropped == _reported ) {
+                return;
+            }
+
+            std::stable_sort(_batch.begin(), _batch.end(), [](const Record& a, const Record& b) {
+                return a.timestamp < b.timestamp;
+            });
+
+            for ( auto& r : _batch ) {
+                _emit(r);
+            }
+
+            if ( dropped != _reported ) {
+                Record r;
+                r.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                r.thread = 0;
+                r.level = WARNING;
+                r.length = (uint16_t) std::snprintf(r.message, ELMA_LOG_MESSAGE_SIZE,
+                    "logger dropped %lu messages", dropped - _reported);
+                _emit(r);
+                _reported = dropped;
+            }
+
+            std::fflush(_out);
+
+        }
+
+        void _emit(const Record& r) {
+
+            if ( _format == BINARY ) {
+                std::fwrite(&r.timestamp, sizeof(r.timestamp), 1, _out);
+                std::fwrite(&r.thread, sizeof(r.thread), 1, _out);
+                std::fwrite(&r.level, sizeof(r.level), 1, _out);
+                std::fwrite(&r.length, sizeof(r.length), 1, _out);
+                std::fwrite(r.message, 1, r.length, _out);
+                return;
+            }
+
+            if ( _format == JSON_LINES ) {
+                std::fprintf(_out, "{\"ts\":%lld,\"level\":\"%s\",\"thread\":%u,\"msg\":\"",
+                    (long long) r.timestamp, level_name(r.level), r.thread);
+                for ( int i=0; i<r.length; i++ ) {
+                    unsigned char c = r.message[i];
+                    if ( c == '"' || c == '\\' ) {
+                        std::fputc('\\', _out);
+                        std::fputc(c, _out);
+                    } else if ( c == '\n' ) {
+                        std::fputs("\\n", _out);
+                    } else if ( c < 0x20 ) {
+                        std::fprintf(_out, "\\u%04x", c);
+                    } else {
+                        std::fputc(c, _out);
+                    }
+                }
+                std::fputs("\"}\n", _out);
+                return;
+            }
+
+            time_t seconds = (time_t) (r.timestamp / 1000000000);
+            struct tm utc;
+            char stamp[32];
+            gmtime_r(&seconds, &utc);
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+            std::fprintf(_out, "%s.%06lldZ %s [%u] %.*s\n",
+                stamp, (long long) (r.timestamp % 1000000000) / 1000,
+                level_name(r.level), r.thread, (int) r.length, r.message);
+
+        }
+
+        // Flush pending records to the old output, then swap in the new one
+        void _replace_output(FILE * file, bool owns) {
+            flush();
+            std::lock_guard<std::mutex> lock(_write_mtx);
+            _close_output();
+            _out = file;
+            _owns_out = owns;
+        }
+
+        void _close_output() {
+            if ( _owns_out && _out != NULL ) {
+                std::fclose(_out);
+            }
+            _owns_out = false;
+        }
+
+        std::atomic<int> _level;
+        std::atomic<int> _format;
+        FILE * _out;
+        bool _owns_out;
+        std::atomic<long> _interval_ms;
+
+        bool _running;
+        std::thread _flusher;
+        std::mutex _wake_mtx, _write_mtx, _buffers_mtx;
+        std::condition_variable _wake;
+
+        std::vector<std::shared_ptr<Buffer>> _buffers;
+        std::vector<Record> _batch;
+        std::atomic<unsigned long> _dropped;
+        unsigned long _reported;
+
+    };
+
+}
+
+#endif
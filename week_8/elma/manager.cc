@@ -1,10 +1,22 @@
 #include <stdexcept>
 #include <iostream>
+#include <algorithm>
 #include "elma.h"
 
 namespace elma {
 
+    // Marks the manager as iterating over its processes or handlers while
+    // it exists, so that changes to them are deferred
+    struct Manager::Busy {
+        Manager& manager;
+        Busy(Manager& m) : manager(m) { manager._busy++; }
+        ~Busy() { manager._busy--; }
+    };
+
     //! Add a Process to the manager, to be run at a certain frequency.
+    //! May be called while the manager is running, in which case the process
+    //! is added, initialized and started at the end of the current tick.
+    //! Throws an error if the process is already scheduled.
     //! \param process The process to be scheduled, usually derived from the Process abstract base class
     //! \param period The desired duration of time between updates
     //! \return A reference to the manager, for chaining
@@ -12,14 +24,180 @@ namespace elma {
         Process& process, 
         high_resolution_clock::duration period) {
 
+        _check_unscheduled(process);
         process._period = period;
-        _processes.push_back(&process); 
         process._manager_ptr = this;            
+        _defer(process, [this, &process]() { _add(process, true); });
+
+        return *this;
+
+    }
+
+    //! Add a Process to the manager that is initialized, started and stopped
+    //! with the others, but never updated. Such a process acts only when it is
+    //! woken by an event, a channel or a timer, as a CoroutineProcess is, so it
+    //! costs nothing on the ticks in between. May be called while the manager
+    //! is running, like schedule(process, period).
+    //! \param process The process to be scheduled
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::schedule(Process& process) {
+
+        _check_unscheduled(process);
+        process._manager_ptr = this;
+        _defer(process, [this, &process]() { _add(process, false); });
+
+        return *this;
+
+    }
+
+    //! Change the period of a scheduled process. A process scheduled without a
+    //! period starts being updated. May be called while the manager is running,
+    //! in which case the change takes effect at the end of the current tick.
+    //! Throws an error if the process is not scheduled with this manager.
+    //! \param process The process
+    //! \param period The new duration of time between updates
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::reschedule(Process& process, high_resolution_clock::duration period) {
+
+        _check_scheduled(process);
+        _defer(process, [this, &process, period]() {
+            process._period = period;
+            if ( process._periodic_slot < 0 ) {
+                process._periodic_slot = _periodic.size();
+                _periodic.push_back(&process);
+            }
+        });
 
         return *this;
 
     }
 
+    //! Remove a process from the manager, stopping it first if it is running,
+    //! and forget the event handlers it registered with Process::watch. May be
+    //! called while the manager is running, for example by the process itself,
+    //! in which case the process is removed at the end of the current tick.
+    //! Throws an error if the process is not scheduled with this manager, or
+    //! has already been dropped.
+    //! \param process The process
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::drop(Process& process) {
+
+        _check_scheduled(process);
+        process._drop_pending = true;
+        _defer(process, [this, &process]() { _remove(process); });
+
+        return *this;
+
+    }
+
+    void Manager::_check_unscheduled(Process& process) {
+        if ( process._manager_ptr != NULL ) {
+            throw Exception("Tried to schedule process " + process.name() + ", which is already scheduled.");
+        }
+    }
+
+    void Manager::_check_scheduled(Process& process) {
+        if ( process._manager_ptr != this ) {
+            throw Exception("Process " + process.name() + " is not scheduled with this manager.");
+        }
+        if ( process._drop_pending ) {
+            throw Exception("Process " + process.name() + " has already been dropped.");
+        }
+    }
+
+    void Manager::_add(Process& process, bool periodic) {
+        if ( process._drop_pending ) {
+            return; // dropped in the tick it was scheduled in
+        }
+        process._slot = _processes.size();
+        _processes.push_back(&process);
+        if ( periodic ) {
+            process._periodic_slot = _periodic.size();
+            _periodic.push_back(&process);
+        }
+        if ( _running ) {
+            process._init();
+            process._start(_elapsed);
+        }
+    }
+
+    // Removal leaves an empty slot, so that it is O(1) and keeps the order in
+    // which the other processes are updated. The slots are compacted once
+    // more than half of them are empty.
+    void Manager::_remove(Process& process) {
+        if ( process._status == Process::RUNNING ) {
+            process._stop();
+        }
+        process._end_http_subscriptions();
+        _forget(process);
+        for ( auto& subscription : process._subscriptions ) {
+            subscription.unsubscribe();
+        }
+        process._subscriptions.clear();
+        process._drop_pending = false;
+        if ( 2 * _empty_slots > _processes.size() + _periodic.size() ) {
+            _compact(_processes, &Process::_slot);
+            _compact(_periodic, &Process::_periodic_slot);
+            _empty_slots = 0;
+        }
+    }
+
+    // Empty the slots of a process. Safe while iterating over them.
+    void Manager::_forget(Process& process) {
+        if ( process._slot >= 0 ) {
+            _processes[process._slot] = NULL;
+            _empty_slots++;
+        }
+        if ( process._periodic_slot >= 0 ) {
+            _periodic[process._periodic_slot] = NULL;
+            _empty_slots++;
+        }
+        process._slot = process._periodic_slot = -1;
+        process._manager_ptr = NULL;
+    }
+
+    void Manager::_compact(vector<Process *>& processes, int Process::* slot) {
+        processes.erase(std::remove(processes.begin(), processes.end(), (Process *) NULL), processes.end());
+        for ( size_t i=0; i<processes.size(); i++ ) {
+            processes[i]->*slot = i;
+        }
+    }
+
+    // Call f now, or at the end of the current tick if the manager is busy
+    void Manager::_defer(std::function<void()> f) {
+        if ( _busy > 0 ) {
+            _deferred.push_back(f);
+        } else {
+            f();
+        }
+    }
+
+    // Defer a change to a process. By the time it is applied, the process may
+    // have been destroyed or removed from this manager, in which case the
+    // change is skipped.
+    void Manager::_defer(Process& process, std::function<void()> f) {
+        std::weak_ptr<bool> alive = process._alive;
+        Process * process_ptr = &process;
+        _defer([this, alive, process_ptr, f]() {
+            if ( !alive.expired() && process_ptr->_manager_ptr == this ) {
+                f();
+            }
+        });
+    }
+
+    void Manager::_apply_deferred() {
+        if ( _busy > 0 ) {
+            return;
+        }
+        while ( !_deferred.empty() ) {
+            vector<std::function<void()>> deferred;
+            deferred.swap(_deferred);
+            for ( auto& f : deferred ) {
+                f();
+            }
+        }
+    }
+
     //! Add a channel to the manager
     //! \param The channel to be added
     //! \return A reference to the manager, for chaining
@@ -28,6 +206,55 @@ namespace elma {
         return *this;
     }
 
+    //! Add a batch channel to the manager
+    //! \param The channel to be added
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::add_channel(BatchChannelBase& channel) {
+        _batch_channels[channel.name()] = &channel;
+        return *this;
+    }
+
+    //! Remove a channel from the manager. May be called while the manager is
+    //! running, in which case the channel is removed at the end of the current
+    //! tick. Throws an error if the channel is not registered.
+    //! \param The channel to be removed
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::drop_channel(Channel& channel) {
+        auto c = _channels.find(channel.name());
+        if ( c == _channels.end() || c->second != &channel ) {
+            throw Exception("Tried to drop an unregistered channel.");
+        }
+        // A channel added under the same name later in the tick stays
+        string name = channel.name();
+        Channel * channel_ptr = &channel;
+        _defer([this, name, channel_ptr]() {
+            auto c = _channels.find(name);
+            if ( c != _channels.end() && c->second == channel_ptr ) {
+                _channels.erase(c);
+            }
+        });
+        return *this;
+    }
+
+    //! Remove a batch channel from the manager. See drop_channel(Channel&).
+    //! \param The channel to be removed
+    //! \return A reference to the manager, for chaining
+    Manager& Manager::drop_channel(BatchChannelBase& channel) {
+        auto c = _batch_channels.find(channel.name());
+        if ( c == _batch_channels.end() || c->second != &channel ) {
+            throw Exception("Tried to drop an unregistered batch channel.");
+        }
+        string name = channel.name();
+        BatchChannelBase * channel_ptr = &channel;
+        _defer([this, name, channel_ptr]() {
+            auto c = _batch_channels.find(name);
+            if ( c != _batch_channels.end() && c->second == channel_ptr ) {
+                _batch_channels.erase(c);
+            }
+        });
+        return *this;
+    }
+
     //! Retrieve a reference to an existing channel. Throws an error if no such channel exists.
     //! \return The channel requested.
     Channel& Manager::channel(string name) {
@@ -48,9 +275,44 @@ namespace elma {
     //! @endcode
     //! \param event_name The name of the event
     //! \handler A function or lambda that takes an event and returns nothing.
-    Manager& Manager::watch(std::string event_name, std::function<void(Event&)> handler) {
-        event_handlers[event_name].push_back(handler);
-        return *this;
+    //! \return A handle with which to unsubscribe the handler
+    Subscription Manager::watch(std::string event_name, std::function<void(Event&)> handler) {
+        return _watch(event_name, handler, false);
+    }
+
+    //! Watch for the next event associated with the given name. The handler is
+    //! called once, in turn with the handlers registered with watch(), and then
+    //! unsubscribed.
+    //! \param event_name The name of the event
+    //! \handler A function or lambda that takes an event and returns nothing.
+    //! \return A handle with which to unsubscribe the handler before it is called
+    Subscription Manager::watch_next(std::string event_name, std::function<void(Event&)> handler) {
+        return _watch(event_name, handler, true);
+    }
+
+    Subscription Manager::_watch(std::string event_name, std::function<void(Event&)> handler, bool once) {
+        HandlerTable& table = event_handlers[event_name];
+        auto state = std::make_shared<Subscription::State>();
+        state->active = true;
+        state->manager = this;
+        state->table = &table;
+        table.handlers.push_back({ state, handler, once });
+        return Subscription(state);
+    }
+
+    // Called when a handler in table is unsubscribed
+    void Manager::_unsubscribed(HandlerTable * table) {
+        table->inactive++;
+        if ( 2 * table->inactive > table->handlers.size() ) {
+            // emit() may be iterating over the table, so compact it when it is done
+            _defer([table]() {
+                auto& h = table->handlers;
+                h.erase(std::remove_if(h.begin(), h.end(), [](const HandlerTable::Handler& handler) {
+                    return !handler.state->active;
+                }), h.end());
+                table->inactive = 0;
+            });
+        }
     }
 
     //! Emit an event associated with a name.
@@ -66,24 +328,184 @@ namespace elma {
     //! \param event The Event to be emitted
     //! \return A reference to the manager for chaining.
     Manager& Manager::emit(const Event& event) {
-        Event e = event; // make a copy so we can change propagation
-        if ( event_handlers.find(event.name()) != event_handlers.end() ) {
-            for ( auto handler : event_handlers[event.name()] ) {
-                if ( e.propagate() ) {
-                  handler(e);
+        {
+            Busy busy(*this);
+            Event e = event; // make a copy so we can change propagation
+            auto table = event_handlers.find(event.name());
+            if ( table != event_handlers.end() ) {
+                // Handlers may watch this event, so only those there now are called,
+                // and each is copied before the call in case the vector grows
+                auto& handlers = table->second.handlers;
+                size_t n = handlers.size();
+                for ( size_t i=0; i<n && e.propagate(); i++ ) {
+                    if ( handlers[i].state->active ) {
+                        auto handler = handlers[i].f;
+                        if ( handlers[i].once ) {
+                            Subscription(handlers[i].state).unsubscribe();
+                        }
+                        handler(e);
+                    }
                 }
             }
         }
+        _apply_deferred();
         return *this;
     }
 
+    //! Cancel the timers that are still pending and detach the subscriptions
+    //! and processes, so that they outlive the manager safely
+    Manager::~Manager() {
+        for ( auto process_ptr : _processes ) {
+            if ( process_ptr != NULL ) {
+                process_ptr->_slot = process_ptr->_periodic_slot = -1;
+                process_ptr->_manager_ptr = NULL;
+                process_ptr->_drop_pending = false;
+            }
+        }
+        for ( auto& table : event_handlers ) {
+            for ( auto& handler : table.second.handlers ) {
+                handler.state->manager = NULL;
+            }
+        }
+        for ( auto& entry : _timers ) {
+            entry.state->manager = NULL;
+            entry.state->in_heap = false;
+        }
+    }
+
+    //! Call a function once, on the first update at or after the given time.
+    //! \param when The time, measured like elapsed() from the start of the run
+    //! \param f The function to call
+    //! \return A handle with which to cancel the call
+    Timer Manager::call_at(high_resolution_clock::duration when, std::function<void()> f) {
+        auto state = std::make_shared<Timer::State>();
+        state->f = f;
+        state->period = high_resolution_clock::duration::zero();
+        state->cancelled = false;
+        state->manager = this;
+        _push_timer(when, state);
+        return Timer(state);
+    }
+
+    //! Call a function once, on the first update after a delay from now.
+    //! A delay of zero calls it on the next update.
+    //! \param delay The delay
+    //! \param f The function to call
+    //! \return A handle with which to cancel the call
+    Timer Manager::call_after(high_resolution_clock::duration delay, std::function<void()> f) {
+        return call_at(_elapsed + delay, f);
+    }
+
+    //! Call a function every period, starting one period from now, until the
+    //! returned timer is cancelled. Periods missed because an update came late
+    //! are skipped rather than made up in a burst, and later calls stay on the
+    //! original schedule rather than drifting.
+    //! \param period The period, which must be positive
+    //! \param f The function to call
+    //! \return A handle with which to cancel the calls
+    Timer Manager::call_every(high_resolution_clock::duration period, std::function<void()> f) {
+        if ( period <= high_resolution_clock::duration::zero() ) {
+            throw Exception("Tried to call a function every non-positive period.");
+        }
+        Timer timer = call_after(period, f);
+        timer._state->period = period;
+        return timer;
+    }
+
+    //! Emit an event at a given time. A time in the past emits it on the next update.
+    //! \param when The time, measured like elapsed() from the start of the run, as for call_at
+    //! \param event The Event to be emitted
+    //! \return A handle with which to cancel the emission
+    Timer Manager::emit_at(high_resolution_clock::duration when, const Event& event) {
+        return call_at(when, [this, event]() { emit(event); });
+    }
+
+    //! Emit an event after a delay from now. Watchdogs and timeouts are usually
+    //! written as an emit_after that is cancelled if what it watches for happens in time.
+    //! \param delay The delay
+    //! \param event The Event to be emitted
+    //! \return A handle with which to cancel the emission
+    Timer Manager::emit_after(high_resolution_clock::duration delay, const Event& event) {
+        return call_after(delay, [this, event]() { emit(event); });
+    }
+
+    //! Emit an event every period, starting one period from now, until the
+    //! returned timer is cancelled. See call_every().
+    //! \param period The period, which must be positive
+    //! \param event The Event to be emitted
+    //! \return A handle with which to cancel the emissions
+    Timer Manager::emit_every(high_resolution_clock::duration period, const Event& event) {
+        return call_every(period, [this, event]() { emit(event); });
+    }
+
+    void Manager::_push_timer(high_resolution_clock::duration when, std::shared_ptr<Timer::State> state) {
+        state->in_heap = true;
+        _timers.push_back({ when, _timer_sequence++, state });
+        std::push_heap(_timers.begin(), _timers.end(), TimerLater());
+    }
+
+    // Call the functions of the timers that are due. Timers they add are left
+    // for the next update, even if already due, so a function that keeps
+    // rescheduling itself cannot stall the manager. Periodic timers are put
+    // back before their function is called, so that it can cancel them.
+    void Manager::_fire_timers() {
+        vector<std::shared_ptr<Timer::State>> due;
+        while ( !_timers.empty() && _timers.front().when <= _elapsed ) {
+            std::pop_heap(_timers.begin(), _timers.end(), TimerLater());
+            TimerEntry entry = std::move(_timers.back());
+            _timers.pop_back();
+            entry.state->in_heap = false;
+            if ( entry.state->cancelled ) {
+                _cancelled_timers--;
+            } else if ( entry.state->period > high_resolution_clock::duration::zero() ) {
+                do {
+                    entry.when += entry.state->period;
+                } while ( entry.when <= _elapsed );
+                due.push_back(entry.state);
+                _push_timer(entry.when, entry.state);
+            } else {
+                due.push_back(entry.state);
+            }
+        }
+        for ( auto& state : due ) {
+            if ( !state->cancelled ) { // an earlier function may have cancelled it
+                state->f();
+            }
+        }
+    }
+
+    // Called when a timer in the heap is cancelled. Cancelled entries are left
+    // in place and skipped when they come due, unless they make up more than
+    // half the heap, which is then rebuilt without them. Watchdogs that are
+    // cancelled and re-armed over and over so cost O(log n) amortized.
+    void Manager::_timer_cancelled() {
+        _cancelled_timers++;
+        if ( _cancelled_timers > 16 && 2 * _cancelled_timers > _timers.size() ) {
+            auto live = std::remove_if(_timers.begin(), _timers.end(), [](const TimerEntry& entry) {
+                if ( entry.state->cancelled ) {
+                    entry.state->in_heap = false;
+                }
+                return entry.state->cancelled;
+            });
+            _timers.erase(live, _timers.end());
+            std::make_heap(_timers.begin(), _timers.end(), TimerLater());
+            _cancelled_timers = 0;
+        }
+    }
+
     //! Apply a function to all processes.
     //! \param f The function to apply. It should take a reference to a process and return void.
     //! \return A reference to the manager, for chaining
     Manager& Manager::all(std::function< void(Process&) > f) {
-        for(auto process_ptr : _processes) {
-            f(*process_ptr);
+        {
+            Busy busy(*this);
+            for(auto process_ptr : _processes) {
+                if ( process_ptr != NULL ) {
+                    f(*process_ptr);
+                }
+            }
         }
+        _apply_deferred();
         return *this;
     }
 
@@ -106,14 +528,22 @@ namespace elma {
     }    
 
     //! Update all processes if enough time has passed. Usually not called directly.
+    //! Processes scheduled, rescheduled or dropped during the update take
+    //! effect at its end.
     //! \return A reference to the manager, for chaining
     Manager& Manager::update() {
-        _client.process_responses();
-        return all([this](Process& p) {
-            if ( _elapsed > p.last_update() + p.period() ) {
-                p._update(_elapsed);
+        {
+            Busy busy(*this);
+            _client.process_responses();
+            _fire_timers();
+            for ( auto process_ptr : _periodic ) {
+                if ( process_ptr != NULL && _elapsed > process_ptr->last_update() + process_ptr->period() ) {
+                    process_ptr->_update(_elapsed);
+                }
             }
-        });
+        }
+        _apply_deferred();
+        return *this;
     }
 
     //! Run the manager for the specified amount of time.
@@ -123,6 +553,7 @@ namespace elma {
 
         _start_time = high_resolution_clock::now();
         _elapsed = high_resolution_clock::duration::zero();
+        _running = true;
         start();        
 
         while ( _elapsed < runtime ) {
@@ -131,6 +562,7 @@ namespace elma {
         }
 
         stop();
+        _running = false;
 
         return *this;
 
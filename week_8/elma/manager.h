@@ -5,6 +5,7 @@
 #include <map>
 #include <chrono>
 #include <functional>
+#include <memory>
 
 #include "elma.h"
 
@@ -18,6 +19,19 @@ namespace elma {
     class Channel;
     class Process;
 
+    //! The handlers watching one event name. Unsubscribed handlers are marked
+    //! inactive and skipped, and removed together once they are more than half
+    //! of the table, so unsubscribing is O(1) and the vector keeps its capacity.
+    struct HandlerTable {
+        struct Handler {
+            std::shared_ptr<Subscription::State> state;
+            std::function<void(Event&)> f;
+            bool once;
+        };
+        vector<Handler> handlers;
+        size_t inactive = 0;
+    };
+
     //! The Process Manager class. 
 
     //! Example usage:
@@ -27,10 +41,19 @@ namespace elma {
 
         public: 
 
+        friend class Timer;
+        friend class Subscription;
+        friend class Process;
+
         //! Default constructor
-        Manager() {}
+        Manager() : _timer_sequence(0), _cancelled_timers(0), _busy(0), _running(false), _empty_slots(0),
+                    _elapsed(high_resolution_clock::duration::zero()) {}
+        ~Manager();
         
         Manager& schedule(Process& process, high_resolution_clock::duration period);
+        Manager& schedule(Process& process);
+        Manager& reschedule(Process& process, high_resolution_clock::duration period);
+        Manager& drop(Process& process);
         Manager& all(std::function<void(Process&)> f);
 
         Manager& init();
@@ -51,22 +74,93 @@ namespace elma {
         // Channel Interface
         Manager& add_channel(Channel&);
         Channel& channel(string);
+        Manager& add_channel(BatchChannelBase&);
+        Manager& drop_channel(Channel&);
+        Manager& drop_channel(BatchChannelBase&);
+        template <typename T> BatchChannel<T>& batch_channel(string);
 
         // Event Interface
-        Manager& watch(string event_name, std::function<void(Event&)> handler);
+        Subscription watch(string event_name, std::function<void(Event&)> handler);
+        Subscription watch_next(string event_name, std::function<void(Event&)> handler);
         Manager& emit(const Event& event);
+
+        // Timer Interface
+        Timer call_at(high_resolution_clock::duration when, std::function<void()> f);
+        Timer call_after(high_resolution_clock::duration delay, std::function<void()> f);
+        Timer call_every(high_resolution_clock::duration period, std::function<void()> f);
+        Timer emit_at(high_resolution_clock::duration when, const Event& event);
+        Timer emit_after(high_resolution_clock::duration delay, const Event& event);
+        Timer emit_every(high_resolution_clock::duration period, const Event& event);
         Client& client() { return _client; }
 
         private:
-        vector<Process *> _processes;
+
+        // An entry in the timer heap. The sequence number keeps timers due at
+        // the same time in the order they were added.
+        struct TimerEntry {
+            high_resolution_clock::duration when;
+            long long sequence;
+            std::shared_ptr<Timer::State> state;
+        };
+
+        // Orders the timer heap so that the earliest timer is at the front
+        struct TimerLater {
+            bool operator()(const TimerEntry& a, const TimerEntry& b) const {
+                return a.when > b.when || ( a.when == b.when && a.sequence > b.sequence );
+            }
+        };
+
+        struct Busy;
+
+        void _check_unscheduled(Process& process);
+        void _check_scheduled(Process& process);
+        void _add(Process& process, bool periodic);
+        void _remove(Process& process);
+        void _forget(Process& process);
+        void _compact(vector<Process *>& processes, int Process::* slot);
+        void _defer(std::function<void()> f);
+        void _defer(Process& process, std::function<void()> f);
+        void _apply_deferred();
+        Subscription _watch(string event_name, std::function<void(Event&)> handler, bool once);
+        void _unsubscribed(HandlerTable * table);
+        void _push_timer(high_resolution_clock::duration when, std::shared_ptr<Timer::State> state);
+        void _fire_timers();
+        void _timer_cancelled();
+
+        vector<Process *> _processes; // NULL where a process was dropped
+        vector<Process *> _periodic;  // the processes updated every period, likewise
         map<string, Channel *> _channels;
-        map<string, vector<std::function<void(Event&)>>> event_handlers;
+        map<string, BatchChannelBase *> _batch_channels;
+        map<string, HandlerTable> event_handlers; // nodes never move, so subscriptions can point at tables
+        vector<TimerEntry> _timers;
+        long long _timer_sequence;
+        size_t _cancelled_timers; // cancelled entries still in _timers
+        int _busy;                // depth of iterations over processes and handlers
+        bool _running;            // true between start() and stop() in run()
+        size_t _empty_slots;      // NULL entries in _processes and _periodic
+        vector<std::function<void()>> _deferred;
         high_resolution_clock::time_point _start_time;
         high_resolution_clock::duration _elapsed;
         Client _client;
 
     };
 
+    //! Retrieve a reference to an existing batch channel. Throws an error if no such
+    //! channel exists, or if its values are not of type T.
+    //! \return The channel requested.
+    template <typename T>
+    BatchChannel<T>& Manager::batch_channel(string name) {
+        auto c = _batch_channels.find(name);
+        if ( c == _batch_channels.end() ) {
+            throw Exception("Tried to access an unregistered or non-existant batch channel.");
+        }
+        auto typed = dynamic_cast<BatchChannel<T> *>(c->second);
+        if ( typed == NULL ) {
+            throw Exception("Batch channel " + name + " does not hold values of the requested type.");
+        }
+        return *typed;
+    }
+
 }
 
 #endif
\ No newline at end of file
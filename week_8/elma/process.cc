@@ -1,4 +1,5 @@
 #include <stdexcept>
+#include <algorithm>
 #include "elma.h"
 
 namespace elma {
@@ -16,12 +17,48 @@ namespace elma {
         }
     }
 
-    void Process::watch(string event_name, std::function<void(Event&)> handler) {
+    //! Watch for an event through the manager. See Manager::watch. The handler is
+    //! unsubscribed when the process is dropped from the manager or destroyed, so
+    //! it may capture this.
+    /*!
+      \param event_name The name of the event
+      \param handler A function or lambda that takes an event and returns nothing
+      \return A handle with which to unsubscribe the handler sooner
+    */
+    Subscription Process::watch(string event_name, std::function<void(Event&)> handler) {
         if ( _manager_ptr == NULL ) {
             throw Exception("Cannot access events in a process before the process is scheduled.");
-        } else {        
-            _manager_ptr->watch(event_name, handler);
         }
+        if ( _subscriptions.size() == _subscriptions.capacity() ) {
+            // Forget unsubscribed handles before the vector would grow
+            _subscriptions.erase(std::remove_if(_subscriptions.begin(), _subscriptions.end(),
+                [](const Subscription& s) { return !s.active(); }), _subscriptions.end());
+        }
+        Subscription subscription = _manager_ptr->watch(event_name, handler);
+        _subscriptions.push_back(subscription);
+        return subscription;
+    }
+
+    // A process destroyed while scheduled leaves an empty slot in its manager
+    Process::~Process() {
+        for ( auto& subscription : _subscriptions ) {
+            subscription.unsubscribe();
+        }
+        if ( _manager_ptr != NULL ) {
+            _end_http_subscriptions();
+            _manager_ptr->_forget(*this);
+        }
+    }
+
+    // Stop the subscriptions made with http_subscribe that are still active
+    void Process::_end_http_subscriptions() {
+        Client& client = _manager_ptr->client();
+        for ( int id : _http_subscriptions ) {
+            if ( client.subscribed(id) ) {
+                client.unsubscribe(id);
+            }
+        }
+        _http_subscriptions.clear();
     }
 
     void Process::emit(const Event& event) {
@@ -36,6 +73,28 @@ namespace elma {
         _manager_ptr->client().get(url,handler);
     }
 
+    //! Subscribe to a long polling endpoint through the manager's client. See Client::subscribe.
+    //! The subscription ends when the process is dropped or destroyed, and items that
+    //! arrive for it after the process is destroyed are ignored.
+    /*!
+      \param url The url of the endpoint
+      \param handler A function called with each item the endpoint sends
+      \return An id to pass to the client's unsubscribe() method
+    */
+    int Process::http_subscribe(std::string url, std::function<void(json&)> handler) {
+        if ( _manager_ptr == NULL ) {
+            throw Exception("Cannot subscribe in a process before the process is scheduled.");
+        }
+        std::weak_ptr<bool> alive = _alive;
+        int id = _manager_ptr->client().subscribe(url, [alive, handler](json& item) {
+            if ( !alive.expired() ) {
+                handler(item);
+            }
+        });
+        _http_subscriptions.push_back(id);
+        return id;
+    }
+
     //! The time since the last update in millisconds, as a double
     /*!
       \return The time since the last update, in milliseconds
@@ -4,6 +4,8 @@
 #include <string>
 #include <chrono>
 #include <functional>
+#include <vector>
+#include <memory>
 
 #include "elma.h"
 
@@ -32,14 +34,16 @@ namespace elma {
         typedef enum { UNINITIALIZED, STOPPED, RUNNING } status_type;
 
         //! Default constructor. Names process "no name"
-        Process() : _name("unnamed process"), _status(UNINITIALIZED), _manager_ptr(NULL) {}
+        Process() : _name("unnamed process"), _status(UNINITIALIZED), _manager_ptr(NULL), _slot(-1), _periodic_slot(-1),
+            _drop_pending(false), _alive(std::make_shared<bool>(true)) {}
 
         //! Constructor that takes a name for the process
         /*!
           \param name The name of the process
         */
-        Process(std::string name) : _name(name), _status(UNINITIALIZED), _manager_ptr(NULL) {}
-        virtual ~Process() = default;
+        Process(std::string name) : _name(name), _status(UNINITIALIZED), _manager_ptr(NULL), _slot(-1), _periodic_slot(-1),
+            _drop_pending(false), _alive(std::make_shared<bool>(true)) {}
+        virtual ~Process();
 
         // Interface for derived classes
 
@@ -97,15 +101,21 @@ namespace elma {
         //! time the Manager called the update() method.        
         inline high_resolution_clock::duration previous_update() { return _previous_update; }
 
+        //! Getter
+        //! \return The manager the process is scheduled with, or NULL if it is not scheduled
+        inline Manager * manager() { return _manager_ptr; }
+
         // documentation for these methods is in process.cc
         Channel& channel(string name);
+        template <typename T> BatchChannel<T>& batch_channel(string name); // defined in batch_process.h
         double milli_time();
         double delta();
 
-        void watch(string event_name, std::function<void(Event&)> handler);
+        Subscription watch(string event_name, std::function<void(Event&)> handler);
         void emit(const Event& event);
 
         void http_get(std::string url, std::function<void(json&)> handler);
+        int http_subscribe(std::string url, std::function<void(json&)> handler);
 
         private:
 
@@ -114,6 +124,7 @@ namespace elma {
         void _start(high_resolution_clock::duration elapsed);
         void _update(high_resolution_clock::duration elapsed);
         void _stop();
+        void _end_http_subscriptions();
 
         // Instance variables
         string _name;
@@ -124,6 +135,11 @@ namespace elma {
         time_point<high_resolution_clock> _start_time;    // time of most recent start
         int _num_updates;                                 // number of times update() has been called
         Manager * _manager_ptr;                           // a pointer to the manager        
+        int _slot, _periodic_slot;                        // indices in the manager's lists, or -1
+        std::vector<Subscription> _subscriptions;         // handlers registered with watch()
+        std::vector<int> _http_subscriptions;             // ids returned by http_subscribe()
+        bool _drop_pending;                               // drop() called, removal deferred to the end of the tick
+        std::shared_ptr<bool> _alive;                     // expires with the process, cancelling deferred changes
 
     };
 
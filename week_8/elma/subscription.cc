@@ -0,0 +1,17 @@
+#include "elma.h"
+
+namespace elma {
+
+    //! Unsubscribe the handler, which is not called again. Does nothing if it
+    //! is already unsubscribed, or if the handle is empty.
+    void Subscription::unsubscribe() {
+        if ( !_state || !_state->active ) {
+            return;
+        }
+        _state->active = false;
+        if ( _state->manager != NULL ) {
+            _state->manager->_unsubscribed(_state->table);
+        }
+    }
+
+}
@@ -0,0 +1,55 @@
+#ifndef _SUBSCRIPTION_H
+#define _SUBSCRIPTION_H
+
+#include <memory>
+
+namespace elma {
+
+    class Manager;
+    struct HandlerTable;
+
+    //! A handle to an event handler registered with Manager::watch or watch_next.
+
+    //! Copies of a handle refer to the same handler. Dropping the handle
+    //! does not unsubscribe the handler: handlers registered through
+    //! Process::watch are unsubscribed when the process is dropped or
+    //! destroyed, and others last as long as the Manager unless unsubscribed.
+    //! @code
+    //!     Subscription s = m.watch("door opened", [](Event& e) { ... });
+    //!     ...
+    //!     s.unsubscribe();
+    //! @endcode
+    class Subscription {
+
+        public:
+
+        friend class Manager;
+        friend struct HandlerTable;
+
+        //! Default constructor, for a handle to no handler
+        Subscription() {}
+
+        void unsubscribe();
+
+        //! Getter
+        //! \return True if the handler will be called for the events it watches
+        inline bool active() const { return _state && _state->active; }
+
+        private:
+
+        // Shared by the handles and the Manager's handler table
+        struct State {
+            bool active;
+            Manager * manager;   // NULL once the manager is gone
+            HandlerTable * table;
+        };
+
+        explicit Subscription(std::shared_ptr<State> state) : _state(state) {}
+
+        std::shared_ptr<State> _state;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+#include "elma.h"
+
+namespace {
+
+    using namespace elma;
+    using std::vector;
+
+    // Each instance adds its own step to its position and reports it
+    class Walkers : public BatchProcess<int> {
+        public:
+        Walkers(string name, int n) : BatchProcess(name, n), position(add_column("position")), step(add_column("step", 1)) {
+            for ( int i=0; i<n; i++ ) {
+                step[i] = i;
+            }
+        }
+        void init() {}
+        void start() {}
+        void update() {
+            for ( int i=0; i<size(); i++ ) {
+                position[i] += step[i];
+            }
+            batch_channel("positions").send(position);
+        }
+        void stop() {}
+        vector<int>& position;
+        vector<int>& step;
+    };
+
+    TEST(Batch,Columns) {
+        Walkers w("walkers", 10);
+        ASSERT_EQ(10, w.size());
+        ASSERT_EQ(vector<int>(10, 0), w.column("position"));
+        ASSERT_EQ(9, w.column("step")[9]);
+        w.add_column("extra");
+        ASSERT_EQ(&w.position, &w.column("position")); // references survive new columns
+        ASSERT_THROW(w.add_column("step"), Exception);
+        ASSERT_THROW(w.column("velocity"), Exception);
+    }
+
+    TEST(Batch,Channel) {
+        BatchChannel<double> c("values", 4, 1.5);
+        ASSERT_EQ("values", c.name());
+        ASSERT_EQ(4, c.size());
+        ASSERT_EQ(true, c.empty());
+        ASSERT_THROW(c.latest(0), Exception);
+        ASSERT_THROW(c.latest(), Exception);
+        c.send(2, 3.0);
+        ASSERT_EQ(true, c.nonempty());
+        ASSERT_EQ(vector<double>({ 1.5, 1.5, 3.0, 1.5 }), c.latest());
+        c.send(vector<double>({ 1, 2, 3, 4 }));
+        ASSERT_EQ(4, c.latest(3));
+        c.column()[0] = 7;
+        ASSERT_EQ(7, c.latest(0));
+        ASSERT_THROW(c.send(vector<double>(3)), Exception);
+        ASSERT_THROW(c.send(4, 1.0), std::out_of_range);
+    }
+
+    TEST(Batch,Manager) {
+        Walkers w("walkers", 100);
+        BatchChannel<int> positions("positions", 100);
+        BatchChannel<double> other("other", 100);
+        Manager m;
+        ASSERT_THROW(w.batch_channel("positions"), Exception);
+        m.schedule(w, 1_ms)
+         .add_channel(positions)
+         .add_channel(other);
+        ASSERT_EQ(&positions, &m.batch_channel<int>("positions"));
+        ASSERT_THROW(m.batch_channel<int>("other"), Exception);
+        ASSERT_THROW(m.batch_channel<int>("missing"), Exception);
+        w.update();
+        w.update();
+        for ( int i=0; i<100; i++ ) {
+            ASSERT_EQ(2*i, positions.latest(i));
+        }
+    }
+
+}
@@ -2,6 +2,8 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <thread>
+#include <atomic>
 #include "gtest/gtest.h"
 #include "elma.h"
 
@@ -16,6 +18,17 @@ namespace {
         ASSERT_EQ("/repos/klavins/ecep520", parts.second);
     }
 
+    TEST(Client,Decode) {
+        json reading = { { "id", 3 }, { "temperature", 21.5 }, { "result", "ok" } };
+        std::string cbor, msgpack;
+        json::to_cbor(reading, cbor);
+        json::to_msgpack(reading, msgpack);
+        ASSERT_EQ(reading, Client::decode(Client::content_type(Client::CBOR), cbor));
+        ASSERT_EQ(reading, Client::decode(Client::content_type(Client::MSGPACK), msgpack));
+        ASSERT_EQ(reading, Client::decode("json", reading.dump()));
+        ASSERT_LT(cbor.size(), reading.dump().size());
+    }
+
     TEST(Client,Get) {
 
         Client c;
@@ -37,6 +50,176 @@ namespace {
 
     }
 
+    // A server on this machine, on a free port, so that the cache can be
+    // tested without the network. /find/<id> answers with a reading whose
+    // ETag never changes, and with 304 when the client already has it.
+    class LocalServer {
+
+        public:
+
+        LocalServer() : requests(0), not_modified(0) {
+            _svr.Get(R"(/find/(\d+))", [this](const httplib::Request& req, httplib::Response& res) {
+                requests++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50)); // so that concurrent gets overlap
+                std::string etag = "\"" + std::string(req.matches[1]) + "\"";
+                if ( req.get_header_value("If-None-Match") == etag ) {
+                    not_modified++;
+                    res.status = 304;
+                    return;
+                }
+                res.set_header("ETag", etag.c_str());
+                res.set_content(body(std::stoi(req.matches[1])), "application/json");
+            });
+            _port = _svr.bind_to_any_port("localhost");
+            _thread = std::thread([this]() { _svr.listen_after_bind(); });
+        }
+
+        ~LocalServer() {
+            _svr.stop();
+            _thread.join();
+        }
+
+        std::string url(int id) {
+            return "http://localhost:" + std::to_string(_port) + "/find/" + std::to_string(id);
+        }
+
+        static std::string body(int id) {
+            json reading = { { "result", "ok" }, { "id", id }, { "temperature", 20.5 } };
+            return reading.dump();
+        }
+
+        std::atomic<int> requests, not_modified;
+
+        private:
+
+        httplib::Server _svr;
+        std::thread _thread;
+        int _port;
+
+    };
+
+    // Wait, for at most a second, until the client has n responses to process
+    void wait_for_responses(Client& c, int n) {
+        for ( int i=0; i<1000 && c.num_responses() < n; i++ ) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(n, c.num_responses());
+    }
+
+    TEST(Client,CacheCoalesces) {
+
+        LocalServer server;
+        Client c;
+        c.enable_cache(10_s);
+
+        int received = 0;
+        for( int i=0; i<3; i++ ) {
+            c.get(server.url(1), [&received](json& response) {
+                ASSERT_EQ(1, response["id"]);
+                received++;
+            });
+        }
+
+        wait_for_responses(c, 3);
+        c.process_responses();
+        ASSERT_EQ(3, received);
+        ASSERT_EQ(1, server.requests);
+        ASSERT_EQ(LocalServer::body(1).size(), c.cache_bytes());
+
+    }
+
+    TEST(Client,CacheFromHandler) {
+
+        LocalServer server;
+        Client c;
+        c.enable_cache(10_s);
+
+        // The inner get is answered from the cache while the outer
+        // response is being processed
+        int received = 0;
+        c.get(server.url(1), [&](json& response) {
+            c.get(server.url(1), [&received](json& response) {
+                ASSERT_EQ(1, response["id"]);
+                received++;
+            });
+        });
+
+        wait_for_responses(c, 1);
+        c.process_responses();
+        ASSERT_EQ(1, c.num_responses());
+        ASSERT_EQ(1, c.cache_hits());
+        c.process_responses();
+        ASSERT_EQ(1, received);
+        ASSERT_EQ(1, server.requests);
+
+    }
+
+    TEST(Client,CacheRevalidates) {
+
+        LocalServer server;
+        Client c;
+        c.enable_cache(0_ms); // every get revalidates
+
+        int received = 0;
+        for( int i=0; i<2; i++ ) {
+            c.get(server.url(1), [&received](json& response) {
+                ASSERT_EQ(1, response["id"]);
+                received++;
+            });
+            wait_for_responses(c, 1);
+            c.process_responses();
+        }
+
+        ASSERT_EQ(2, received);
+        ASSERT_EQ(2, server.requests);
+        ASSERT_EQ(1, server.not_modified);
+        ASSERT_EQ(1, c.cache_hits());
+
+    }
+
+    TEST(Client,CacheEvicts) {
+
+        LocalServer server;
+        Client c;
+        size_t bytes = LocalServer::body(1).size(); // the same for every single digit id
+        c.enable_cache(10_s, 2 * bytes);
+
+        auto fetch = [&](int id) {
+            c.get(server.url(id), [id](json& response) {
+                ASSERT_EQ(id, response["id"]);
+            });
+            wait_for_responses(c, 1);
+            c.process_responses();
+        };
+
+        fetch(1);
+        fetch(2);
+        ASSERT_EQ(2 * bytes, c.cache_bytes());
+        fetch(1); // from the cache, making 2 the least recently used
+        fetch(3); // evicts 2
+        ASSERT_EQ(2 * bytes, c.cache_bytes());
+        ASSERT_EQ(3, server.requests);
+
+        fetch(1);
+        ASSERT_EQ(3, server.requests);
+        fetch(2);
+        ASSERT_EQ(4, server.requests);
+        ASSERT_EQ(2, c.cache_hits());
+
+    }
+
+    TEST(Client,Subscriptions) {
+        Client c;
+        int a = c.subscribe("http://localhost/subscribe", [](json& item) {}),
+            b = c.subscribe("http://localhost/subscribe?region=0,0,1,1", [](json& item) {});
+        ASSERT_NE(a,b);
+        ASSERT_EQ(2,c.num_subscriptions());
+        c.unsubscribe(a);
+        ASSERT_EQ(1,c.num_subscriptions());
+        ASSERT_THROW(c.unsubscribe(a),Exception);
+        // The destructor stops b
+    }
+
     class GetTester : public Process {
         public:
         GetTester() : Process("Get Tester") {}
@@ -54,6 +237,29 @@ namespace {
         bool got_response;
     };
 
+    class Subscriber : public Process {
+        public:
+        Subscriber() : Process("Subscriber") {}
+        void init() {}
+        void start() {
+            http_subscribe("http://localhost/subscribe", [this](json& item) { items++; });
+        }
+        void update() {}
+        void stop() {}
+        int items = 0;
+    };
+
+    TEST(Client,ProcessSubscriptions) {
+        Manager m;
+        Subscriber * a = new Subscriber(), b;
+        m.schedule(*a, 1_ms).schedule(b, 1_ms).init().start();
+        ASSERT_EQ(2, m.client().num_subscriptions());
+        delete a; // ends its subscription
+        ASSERT_EQ(1, m.client().num_subscriptions());
+        m.drop(b);
+        ASSERT_EQ(0, m.client().num_subscriptions());
+    }
+
     TEST(Client,ProcessInterface) {
         Manager m;
         GetTester p;
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+#include "elma.h"
+
+namespace {
+
+    using namespace elma;
+    using std::vector;
+
+    class Sleeper : public CoroutineProcess {
+        public:
+        Sleeper() : CoroutineProcess("sleeper") {}
+        Coroutine body() {
+            for ( int i=0; i<3; i++ ) {
+                co_await sleep(20_ms);
+                wakes.push_back(manager()->elapsed());
+            }
+        }
+        vector<high_resolution_clock::duration> wakes;
+    };
+
+    class Waiter : public CoroutineProcess {
+        public:
+        Waiter() : CoroutineProcess("waiter") {}
+        Coroutine body() {
+            steps = 1;
+            Event e = co_await event("go");
+            value = e.value();
+            steps = 2;
+            json v = co_await channel("values").next();
+            value = v;
+            steps = 3;
+            if ( value == "fail" ) {
+                throw Exception("failed");
+            }
+        }
+        int steps = 0;
+        json value;
+    };
+
+    TEST(Coroutine,Sleep) {
+        Manager m;
+        Sleeper s;
+        m.schedule(s).init().run(100_ms);
+        ASSERT_EQ(true, s.done());
+        ASSERT_EQ(3, s.wakes.size());
+        for ( int i=0; i<3; i++ ) {
+            ASSERT_LE((i+1) * 20_ms, s.wakes[i]);
+        }
+        ASSERT_EQ(0, s.num_updates()); // never polled
+    }
+
+    TEST(Coroutine,EventsAndChannels) {
+        Manager m;
+        Waiter w;
+        Channel c("values");
+        m.schedule(w).add_channel(c).init().start();
+        ASSERT_EQ(0, w.steps);
+        m.update();
+        ASSERT_EQ(1, w.steps);
+        m.emit(Event("other")).update();
+        ASSERT_EQ(1, w.steps);
+        m.emit(Event("go", 42));
+        c.send("early"); // sent before the coroutine resumes and waits for it, so not seen
+        m.update();
+        ASSERT_EQ(2, w.steps);
+        ASSERT_EQ(42, w.value);
+        c.send("ok");
+        m.update();
+        ASSERT_EQ(3, w.steps);
+        ASSERT_EQ("ok", w.value);
+        ASSERT_EQ(true, w.done());
+    }
+
+    TEST(Coroutine,Stop) {
+        Manager m;
+        Waiter w;
+        Channel c("values");
+        m.schedule(w).add_channel(c).init().start().update();
+        m.emit(Event("go", 1)).stop();
+        m.update(); // the pending wake up is for a destroyed frame
+        c.send("late");
+        m.update();
+        ASSERT_EQ(1, w.steps);
+        m.start().update();
+        ASSERT_EQ(1, w.steps); // started afresh
+        ASSERT_EQ(false, w.done());
+    }
+
+    TEST(Coroutine,Errors) {
+        Manager m;
+        Waiter w;
+        Channel c("values");
+        ASSERT_THROW(w.start(), Exception);
+        m.schedule(w).add_channel(c).init().start().update();
+        m.emit(Event("go", 1)).update();
+        c.send("fail");
+        ASSERT_THROW(m.update(), Exception);
+        ASSERT_EQ(true, w.done());
+    }
+
+}
@@ -42,4 +42,83 @@ namespace {
 
     }
 
-}
\ No newline at end of file
+    TEST(Event,Unsubscribe) {
+        Manager m;
+        vector<int> calls;
+        Subscription a = m.watch("e", [&](Event& e) { calls.push_back(1); });
+        Subscription b = m.watch("e", [&](Event& e) { calls.push_back(2); });
+        Subscription c = m.watch("e", [&](Event& e) { calls.push_back(3); });
+        a.unsubscribe();
+        a.unsubscribe();
+        ASSERT_EQ(false, a.active());
+        ASSERT_EQ(true, b.active());
+        m.emit(Event("e"));
+        ASSERT_EQ(vector<int>({ 2, 3 }), calls);
+        calls.clear();
+        Subscription d = m.watch("e", [&](Event& e) { calls.push_back(4); c.unsubscribe(); });
+        m.watch_next("e", [&](Event& e) { calls.push_back(5); });
+        b.unsubscribe();
+        m.emit(Event("e")).emit(Event("e"));
+        ASSERT_EQ(vector<int>({ 3, 4, 5, 4 }), calls);
+        Subscription().unsubscribe(); // empty handles are harmless
+    }
+
+    TEST(Event,UnsubscribeDuringEmit) {
+        Manager m;
+        int calls = 0;
+        Subscription later;
+        m.watch("e", [&](Event& e) { later.unsubscribe(); });
+        later = m.watch("e", [&](Event& e) { calls++; });
+        m.emit(Event("e"));
+        ASSERT_EQ(0, calls);
+    }
+
+    TEST(Event,Compaction) {
+        Manager m;
+        int calls = 0;
+        vector<Subscription> subscriptions;
+        for ( int i=0; i<1000; i++ ) {
+            subscriptions.push_back(m.watch("e", [&](Event& e) { calls++; }));
+        }
+        for ( int i=0; i<999; i++ ) {
+            subscriptions[i].unsubscribe();
+        }
+        m.emit(Event("e"));
+        ASSERT_EQ(1, calls);
+        ASSERT_EQ(true, subscriptions[999].active());
+        subscriptions[999].unsubscribe();
+        m.emit(Event("e"));
+        ASSERT_EQ(1, calls);
+    }
+
+    TEST(Event,ProcessLifetime) {
+        Manager m;
+        {
+            TestProcess p("P");
+            m.schedule(p, 10_ms).init();
+            m.drop(p);
+        }
+        m.emit(Event("hello","world")); // the handlers captured this, but are gone
+        Subscription s;
+        {
+            TestProcess p("Q");
+            m.schedule(p, 10_ms).init();
+            s = p.watch("pi", [](Event& e) {});
+        }
+        ASSERT_EQ(false, s.active());
+        m.emit(Event("pi", 3.14));
+        m.run(20_ms); // Q left its slot empty when it was destroyed
+    }
+
+    TEST(Event,OutlivesManager) {
+        Subscription s;
+        {
+            Manager m;
+            s = m.watch("e", [](Event& e) {});
+        }
+        ASSERT_EQ(true, s.active());
+        s.unsubscribe();
+        ASSERT_EQ(false, s.active());
+    }
+
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include "gtest/gtest.h"
+#include "elma.h"
+
+namespace {
+
+    using namespace elma;
+    using std::vector;
+
+    vector<string> read_lines(FILE * f) {
+        vector<string> lines;
+        char buf[512];
+        std::rewind(f);
+        while ( std::fgets(buf, sizeof(buf), f) ) {
+            lines.push_back(buf);
+        }
+        return lines;
+    }
+
+    TEST(Logger,Text) {
+        FILE * f = std::tmpfile();
+        Logger::instance().set_output(f).set_format(Logger::TEXT);
+        ELMA_LOG_INFO("reading " << 42 << " ok");
+        Logger::instance().flush();
+        auto lines = read_lines(f);
+        ASSERT_EQ(1, lines.size());
+        ASSERT_NE(string::npos, lines[0].find("INFO"));
+        ASSERT_NE(string::npos, lines[0].find("reading 42 ok"));
+        Logger::instance().set_output(stdout);
+        std::fclose(f);
+    }
+
+    TEST(Logger,Levels) {
+        FILE * f = std::tmpfile();
+        Logger::instance().set_output(f).set_level(Logger::WARNING);
+        ELMA_LOG_INFO("hidden");
+        ELMA_LOG_DEBUG("hidden"); // removed at compile time with the default ELMA_LOG_LEVEL
+        ELMA_LOG_ERROR("shown");
+        Logger::instance().flush();
+        auto lines = read_lines(f);
+        ASSERT_EQ(1, lines.size());
+        ASSERT_NE(string::npos, lines[0].find("shown"));
+        Logger::instance().set_output(stdout).set_level(Logger::INFO);
+        std::fclose(f);
+    }
+
+    TEST(Logger,JsonLines) {
+        FILE * f = std::tmpfile();
+        Logger::instance().set_output(f).set_format(Logger::JSON_LINES);
+        vector<std::thread> threads;
+        for ( int i=0; i<4; i++ ) {
+            threads.push_back(std::thread([i]() {
+                for ( int j=0; j<10; j++ ) {
+                    ELMA_LOG_WARNING("thread " << i << " said \"" << j << "\"");
+                }
+            }));
+        }
+        for ( auto& t : threads ) {
+            t.join();
+        }
+        Logger::instance().flush();
+        auto lines = read_lines(f);
+        ASSERT_EQ(40, lines.size());
+        long long last = 0;
+        for ( auto line : lines ) {
+            json j = json::parse(line);
+            ASSERT_EQ("WARNING", j["level"]);
+            ASSERT_LE(last, (long long) j["ts"]);
+            last = j["ts"];
+        }
+        Logger::instance().set_output(stdout).set_format(Logger::TEXT);
+        std::fclose(f);
+    }
+
+    TEST(Logger,Binary) {
+        FILE * f = std::tmpfile();
+        Logger::instance().set_output(f).set_format(Logger::BINARY);
+        ELMA_LOG_INFO("abc");
+        Logger::instance().flush();
+        std::rewind(f);
+        int64_t ts;
+        uint32_t thread;
+        uint8_t level;
+        uint16_t length;
+        char msg[4] = { 0 };
+        ASSERT_EQ(1, std::fread(&ts, sizeof(ts), 1, f));
+        ASSERT_EQ(1, std::fread(&thread, sizeof(thread), 1, f));
+        ASSERT_EQ(1, std::fread(&level, sizeof(level), 1, f));
+        ASSERT_EQ(1, std::fread(&length, sizeof(length), 1, f));
+        ASSERT_EQ(Logger::INFO, level);
+        ASSERT_EQ(3, length);
+        ASSERT_EQ(3, std::fread(msg, 1, length, f));
+        ASSERT_STREQ("abc", msg);
+        Logger::instance().set_output(stdout).set_format(Logger::TEXT);
+        std::fclose(f);
+    }
+
+}
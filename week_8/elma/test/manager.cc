@@ -0,0 +1,148 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include "gtest/gtest.h"
+#include "elma.h"
+
+namespace {
+
+    using namespace elma;
+    using std::vector;
+
+    class Counter : public Process {
+        public:
+        Counter(string name, int limit = -1) : Process(name), limit(limit) {}
+        void init() {
+            watch("ping", [this](Event& e) { pings++; });
+            inits++;
+        }
+        void start() {}
+        void update() {
+            if ( num_updates() + 1 == limit ) {
+                manager()->drop(*this);
+            }
+            if ( spawn != NULL && num_updates() == 2 ) {
+                manager()->schedule(*spawn, 1_ms);
+            }
+        }
+        void stop() { stops++; }
+        int limit, inits = 0, stops = 0, pings = 0;
+        Process * spawn = NULL;
+    };
+
+    TEST(Manager,DropDuringRun) {
+        Manager m;
+        Counter a("a", 5), b("b");
+        m.schedule(a, 1_ms).schedule(b, 1_ms).init().run(20_ms);
+        ASSERT_EQ(5, a.num_updates());
+        ASSERT_EQ(1, a.stops);
+        ASSERT_EQ(Process::STOPPED, a.status());
+        ASSERT_EQ(NULL, a.manager());
+        ASSERT_LT(5, b.num_updates());
+        m.emit(Event("ping"));
+        ASSERT_EQ(0, a.pings); // a's handlers went with it
+        ASSERT_EQ(1, b.pings);
+        m.schedule(a, 1_ms); // and it can be scheduled again
+    }
+
+    TEST(Manager,AddDuringRun) {
+        Manager m;
+        Counter a("a"), b("b");
+        a.spawn = &b;
+        m.schedule(a, 1_ms).init().run(20_ms);
+        ASSERT_EQ(1, b.inits);
+        ASSERT_EQ(1, b.stops);
+        ASSERT_LT(5, b.num_updates());
+        ASSERT_GT(a.num_updates(), b.num_updates());
+    }
+
+    TEST(Manager,Reschedule) {
+        Manager m;
+        Counter a("a"), b("b");
+        m.schedule(a, 1_ms).schedule(b).init().run(10_ms);
+        ASSERT_EQ(0, b.num_updates());
+        m.reschedule(b, 1_ms).reschedule(a, 100_ms).run(10_ms);
+        ASSERT_EQ(0, a.num_updates());
+        ASSERT_LT(2, b.num_updates());
+    }
+
+    TEST(Manager,ChangesWithinATick) {
+        Manager m;
+        Counter a("a"), * v = new Counter("v"), * w = new Counter("w"), * x = new Counter("x");
+        m.schedule(a, 1_ms).schedule(*v, 1_ms).schedule(*x, 1_ms).init();
+        m.watch("churn", [&](Event& e) {
+            m.drop(*v);
+            EXPECT_THROW(m.reschedule(*v, 1_ms), Exception); // v is on its way out
+            EXPECT_THROW(m.drop(*v), Exception);
+            m.schedule(*w, 1_ms);
+            delete w; // destroyed before it is added
+            m.drop(*x);
+            delete x; // destroyed before it is removed
+        });
+        m.emit(Event("churn"));
+        ASSERT_EQ(NULL, v->manager());
+        delete v;
+        m.run(5_ms);
+        vector<string> names;
+        m.all([&](Process& p) { names.push_back(p.name()); });
+        ASSERT_EQ(vector<string>({ "a" }), names);
+    }
+
+    TEST(Manager,Compaction) {
+        Manager m;
+        vector<std::unique_ptr<Counter>> counters;
+        for ( int i=0; i<100; i++ ) {
+            counters.emplace_back(new Counter(std::to_string(i)));
+            m.schedule(*counters.back(), 0_ms);
+        }
+        for ( int i=0; i<100; i++ ) {
+            if ( i % 5 != 0 ) {
+                m.drop(*counters[i]);
+            }
+        }
+        vector<string> order;
+        m.all([&](Process& p) { order.push_back(p.name()); });
+        ASSERT_EQ(20, order.size());
+        for ( int i=0; i<20; i++ ) {
+            ASSERT_EQ(std::to_string(5*i), order[i]);
+        }
+        m.init().run(5_ms);
+        for ( int i=0; i<100; i++ ) {
+            ASSERT_EQ(i % 5 == 0 ? 1 : 0, counters[i]->inits);
+        }
+    }
+
+    TEST(Manager,Channels) {
+        Manager m;
+        Channel c("c"), other("c");
+        BatchChannel<int> b("b", 3);
+        m.add_channel(c).add_channel(b);
+        ASSERT_THROW(m.drop_channel(other), Exception);
+        m.watch("drop", [&](Event& e) {
+            m.drop_channel(c).drop_channel(b);
+            m.channel("c"); // still there until the end of the tick
+        });
+        m.emit(Event("drop"));
+        ASSERT_THROW(m.channel("c"), Exception);
+        ASSERT_THROW(m.batch_channel<int>("b"), Exception);
+        m.add_channel(c);
+        m.watch("replace", [&](Event& e) {
+            m.drop_channel(c).add_channel(other);
+        });
+        m.emit(Event("replace"));
+        ASSERT_EQ(&other, &m.channel("c")); // the replacement is kept
+    }
+
+    TEST(Manager,Errors) {
+        Manager m, n;
+        Counter a("a");
+        ASSERT_THROW(m.drop(a), Exception);
+        ASSERT_THROW(m.reschedule(a, 1_ms), Exception);
+        m.schedule(a, 1_ms);
+        ASSERT_THROW(m.schedule(a, 1_ms), Exception);
+        ASSERT_THROW(n.schedule(a), Exception);
+        ASSERT_THROW(n.drop(a), Exception);
+    }
+
+}
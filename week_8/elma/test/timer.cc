@@ -0,0 +1,82 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+#include "elma.h"
+
+namespace {
+
+    using namespace elma;
+    using std::vector;
+
+    TEST(Timer,Order) {
+        Manager m;
+        vector<int> order;
+        m.call_after(0_ms, [&]() { order.push_back(1); });
+        m.call_at(0_ms, [&]() { order.push_back(2); m.call_after(0_ms, [&]() { order.push_back(3); }); });
+        m.update();
+        ASSERT_EQ(vector<int>({ 1, 2 }), order);
+        m.update();
+        ASSERT_EQ(vector<int>({ 1, 2, 3 }), order);
+    }
+
+    TEST(Timer,EmitAfter) {
+        Manager m;
+        vector<string> seen;
+        m.watch("timeout", [&](Event& e) { seen.push_back(e.value()); });
+        Timer a = m.emit_after(20_ms, Event("timeout", "a")),
+              b = m.emit_after(10_ms, Event("timeout", "b")),
+              c = m.emit_at(30_ms, Event("timeout", "c"));
+        ASSERT_EQ(true, b.active());
+        b.cancel();
+        b.cancel();
+        ASSERT_EQ(false, b.active());
+        m.run(50_ms);
+        ASSERT_EQ(vector<string>({ "a", "c" }), seen);
+        ASSERT_EQ(false, a.active());
+        Timer().cancel(); // empty handles are harmless
+    }
+
+    TEST(Timer,Every) {
+        Manager m;
+        int ticks = 0, tocks = 0;
+        Timer tick = m.emit_every(10_ms, Event("tick"));
+        Timer tock = m.call_every(10_ms, [&]() {
+            if ( ++tocks == 3 ) {
+                tock.cancel();
+            }
+        });
+        m.watch("tick", [&](Event& e) { ticks++; });
+        m.run(105_ms);
+        ASSERT_LE(9, ticks);
+        ASSERT_GE(10, ticks);
+        ASSERT_EQ(true, tick.active());
+        ASSERT_EQ(3, tocks);
+        ASSERT_EQ(false, tock.active());
+        ASSERT_THROW(m.call_every(0_ms, [](){}), Exception);
+    }
+
+    TEST(Timer,Watchdog) {
+        Manager m;
+        int timeouts = 0;
+        m.watch("timeout", [&](Event& e) { timeouts++; });
+        Timer watchdog = m.emit_after(10_ms, Event("timeout"));
+        for ( int i=0; i<1000; i++ ) {
+            watchdog.cancel();
+            watchdog = m.emit_after(10_ms, Event("timeout"));
+        }
+        m.run(30_ms);
+        ASSERT_EQ(1, timeouts);
+    }
+
+    TEST(Timer,OutlivesManager) {
+        Timer t;
+        {
+            Manager m;
+            t = m.call_after(1_ms, [](){});
+        }
+        ASSERT_EQ(false, t.active());
+        t.cancel();
+    }
+
+}
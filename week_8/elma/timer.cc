@@ -0,0 +1,17 @@
+#include "elma.h"
+
+namespace elma {
+
+    //! Cancel the timer. Does nothing if it has already fired or been cancelled,
+    //! or if the handle is empty.
+    void Timer::cancel() {
+        if ( !_state || _state->cancelled ) {
+            return;
+        }
+        _state->cancelled = true;
+        if ( _state->in_heap && _state->manager != NULL ) {
+            _state->manager->_timer_cancelled();
+        }
+    }
+
+}
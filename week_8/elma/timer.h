@@ -0,0 +1,61 @@
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace elma {
+
+    using namespace std::chrono;
+
+    class Manager;
+
+    //! A handle to a callback scheduled with the Manager.
+
+    //! Returned by Manager::call_at, call_after, call_every, emit_at, emit_after
+    //! and emit_every. Copies of a handle refer to the same timer. Dropping the
+    //! handle does not cancel the timer. For example, a watchdog that emits
+    //! an event unless it is fed every 500 ms is
+    //! @code
+    //!     Timer watchdog = m.emit_after(500_ms, Event("timeout"));
+    //!     ...
+    //!     watchdog.cancel(); // fed in time
+    //!     watchdog = m.emit_after(500_ms, Event("timeout"));
+    //! @endcode
+    class Timer {
+
+        public:
+
+        friend class Manager;
+
+        //! Default constructor, for a handle to no timer
+        Timer() {}
+
+        void cancel();
+
+        //! Getter
+        //! \return True if the timer will still fire: it has not been
+        //! cancelled, and it is periodic or has not yet fired
+        inline bool active() const { return _state && _state->in_heap && !_state->cancelled; }
+
+        private:
+
+        // Shared by the handles and the Manager's timer heap
+        struct State {
+            std::function<void()> f;
+            high_resolution_clock::duration period; // zero for a one shot timer
+            bool cancelled;
+            bool in_heap;
+            Manager * manager;                      // NULL once the manager is gone
+        };
+
+        explicit Timer(std::shared_ptr<State> state) : _state(state) {}
+
+        std::shared_ptr<State> _state;
+
+    };
+
+}
+
+#endif
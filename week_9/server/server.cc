@@ -1,9 +1,16 @@
 #include "httplib/httplib.h"
 #include "json/json.h"
+#include "logger.h"
 #include <iostream>
 #include <ctime>
+#include <cstdio>
+#include <algorithm>
 #include <map>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 long int unix_timestamp() {
     time_t t = std::time(0);
@@ -11,12 +18,76 @@ long int unix_timestamp() {
     return now;
 }
 
-int main(void)
+// The encoding a client prefers, from the q values in its Accept header. Of
+// the supported types with the highest q, the one listed first wins. Clients
+// that do not ask for CBOR or MessagePack get JSON.
+std::string preferred_type(const httplib::Request& req) {
+    std::string accept = req.get_header_value("Accept"),
+                best = "json";
+    double best_q = 0;
+    size_t start = 0;
+    while ( start < accept.size() ) {
+        size_t end = std::min(accept.find(',', start), accept.size()),
+               params = std::min(accept.find(';', start), end);
+        std::string type = accept.substr(start, params - start);
+        type.erase(std::remove(type.begin(), type.end(), ' '), type.end());
+        double q = 1;
+        size_t q_pos = accept.find("q=", params);
+        if ( q_pos < end ) {
+            q = std::atof(accept.c_str() + q_pos + 2);
+        }
+        if ( q > best_q && ( type == "application/json" || type == "application/cbor" || 
+                             type == "application/msgpack" ) ) {
+            best_q = q;
+            best = type == "application/json" ? "json" : type;
+        }
+        start = end + 1;
+    }
+    return best;
+}
+
+// Send result to the client in the encoding it asked for
+void reply(const httplib::Request& req, httplib::Response& res, const nlohmann::json& result) {
+    using nlohmann::json;
+    std::string type = preferred_type(req);
+    if ( type == "application/cbor" ) {
+        std::vector<uint8_t> bytes = json::to_cbor(result);
+        res.set_content((const char *) bytes.data(), bytes.size(), type.c_str());
+    } else if ( type == "application/msgpack" ) {
+        std::vector<uint8_t> bytes = json::to_msgpack(result);
+        res.set_content((const char *) bytes.data(), bytes.size(), type.c_str());
+    } else {
+        res.set_content(result.dump(), "json");
+    }
+}
+
+// Decode a request body according to its Content-Type
+nlohmann::json parse_body(const httplib::Request& req) {
+    using nlohmann::json;
+    std::string type = req.get_header_value("Content-Type");
+    if ( type.find("cbor") != std::string::npos ) {
+        return json::from_cbor(req.body);
+    } else if ( type.find("msgpack") != std::string::npos ) {
+        return json::from_msgpack(req.body);
+    } else {
+        return json::parse(req.body);
+    }
+}
+
+int main(int argc, char * argv[])
 {
     using namespace httplib;
     using nlohmann::json; 
+    using elma::Logger;
+
+    // Optionally choose the log format with ./server text|json|binary
+    if ( argc > 1 && std::string(argv[1]) == "json" ) {
+        Logger::instance().set_format(Logger::JSON_LINES);
+    } else if ( argc > 1 && std::string(argv[1]) == "binary" ) {
+        Logger::instance().set_format(Logger::BINARY);
+    }
 
-    std::cout << "Starting server\n";
+    ELMA_LOG_INFO("Starting server");
 
     Server svr;
 
@@ -27,21 +98,36 @@ int main(void)
     std::map<int, std::tuple<int,       double, double, double>> database;
     int next_id = 0;
 
+    // Guards database and next_id. Subscribers wait on new_reading for saves.
+    std::mutex database_mtx;
+    std::condition_variable new_reading;
+
+    auto reading = [&](int id) {
+        return json({
+            { "id", id },
+            { "timestamp", std::get<0>(database[id]) },
+            { "x", std::get<1>(database[id]) },
+            { "y", std::get<2>(database[id]) },
+            { "temperature", std::get<3>(database[id]) }
+        });
+    };
+
     svr.Post("/save", [&](const Request& req, Response& res) { 
 
         json request, result;
 
         try {
-            request = json::parse(req.body);
+            request = parse_body(req);
         } catch(json::exception e) {
             result["result"] = "error";
             result["message"] = e.what();
-            res.set_content(result.dump(), "json");
+            reply(req, res, result);
             return;
         }
 
-        std::cout << "Got new save request " << request.dump() << std::endl;  
+        ELMA_LOG_INFO("Got new save request " << request.dump());
 
+        std::unique_lock<std::mutex> lock(database_mtx);
         database[next_id] = std::make_tuple(
           unix_timestamp(),
           request["x"].is_number() ? (double) request["x"] : 0,
@@ -51,29 +137,98 @@ int main(void)
 
         result["result"] = "ok";
         result["id"] = next_id++;
-        res.set_content(result.dump(), "json");
+        lock.unlock();
+        new_reading.notify_all();
+        reply(req, res, result);
 
     });
 
     svr.Get(R"(/find/(\d+))", [&](const Request& req, Response& res) {
-        std::cout << "Got find request for id = " << req.matches[1] << "\n";
+        ELMA_LOG_INFO("Got find request for id = " << req.matches[1]);
         auto id = std::stoi(req.matches[1].str());
         json result;
+        std::lock_guard<std::mutex> lock(database_mtx);
         if ( database.find(id) != database.end() ) {
-            result = { 
-                { "result", "ok" },
-                { "id", id },
-                { "timestamp", std::get<0>(database[id]) },
-                { "x", std::get<1>(database[id]) },
-                { "y", std::get<2>(database[id]) },
-                { "temperature", std::get<3>(database[id]) }                                      
-            };
+            result = reading(id);
+            result["result"] = "ok";
         } else {
             result["result"] = "error";
             result["message"] = "not found";
             res.status = 404;
         }
-        res.set_content(result.dump(), "json");
+        reply(req, res, result);
+    });
+
+    // Long poll for new readings. Responds as soon as there are readings with
+    // ids greater than after that pass the filters, or with an empty list after
+    // wait seconds. Clients pass the returned next value as after in their
+    // following request. Without after, only readings saved from now on are sent.
+    // Each waiting subscriber holds one of the server's worker threads, of which
+    // httplib has only a few (8 by default), so wait is capped at MAX_WAIT seconds
+    // and a handful of idle subscribers delays other requests by at most that.
+    //   /subscribe?after=12&wait=10&region=x0,y0,x1,y1&from=0&to=100
+    const int MAX_WAIT = 10;
+    svr.Get("/subscribe", [&](const Request& req, Response& res) {
+
+        json result;
+        double x0, y0, x1, y1;
+        bool in_region = req.has_param("region"),
+             has_after = req.has_param("after");
+        int from = 0, to = -1, after = 0, wait = 10;
+
+        try {
+            if ( in_region && sscanf(req.get_param_value("region").c_str(), 
+                                     "%lf,%lf,%lf,%lf", &x0, &y0, &x1, &y1) != 4 ) {
+                throw std::invalid_argument("region should be x0,y0,x1,y1");
+            }
+            if ( req.has_param("from") ) from = std::stoi(req.get_param_value("from"));
+            if ( req.has_param("to") ) to = std::stoi(req.get_param_value("to"));
+            if ( req.has_param("wait") ) wait = std::min(MAX_WAIT, std::max(0, std::stoi(req.get_param_value("wait"))));
+            if ( has_after ) after = std::stoi(req.get_param_value("after"));
+        } catch ( std::exception& e ) {
+            result["result"] = "error";
+            result["message"] = e.what();
+            res.status = 400;
+            reply(req, res, result);
+            return;
+        }
+
+        auto matches = [&](int id) {
+            double x = std::get<1>(database[id]),
+                   y = std::get<2>(database[id]);
+            return id >= from && ( to < 0 || id <= to ) &&
+                   ( !in_region || ( x >= x0 && x <= x1 && y >= y0 && y <= y1 ) );
+        };
+
+        std::unique_lock<std::mutex> lock(database_mtx);
+        if ( !has_after ) {
+            after = next_id - 1;
+        }
+
+        ELMA_LOG_INFO("Got subscribe request after id = " << after);
+
+        json items = json::array();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(wait);
+        while ( true ) {
+            // Only readings saved since the last pass need to be checked
+            for ( auto it = database.upper_bound(after); it != database.end(); it++ ) {
+                if ( matches(it->first) ) {
+                    items.push_back(reading(it->first));
+                }
+                after = it->first;
+            }
+            if ( items.size() > 0 || 
+                 new_reading.wait_until(lock, deadline) == std::cv_status::timeout ) {
+                break;
+            }
+        }
+        lock.unlock();
+
+        result["result"] = "ok";
+        result["items"] = items;
+        result["next"] = after;
+        reply(req, res, result);
+
     });
 
     svr.listen("0.0.0.0", 80); // Note, only this port is exposed to 